@@ -0,0 +1,33 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+//------------------------------------------------------------------------------------
+// Texture Atlas
+//------------------------------------------------------------------------------------
+// Sprites, flags and a solid block for shapes are packed into images/atlas.png by
+// sok_atlas (tools/atlas.c) at build time, so a frame draws them all from one texture
+// without flushing the batch. The packer also writes atlas_rects.h with the pixel
+// rectangle of every sprite, indexed by AtlasSprite.
+//
+// To add a sprite, list it here and rebuild: X(id, image file or NULL for the solid block)
+#define ATLAS_SPRITES(X) \
+    X(ATLAS_BACKGROUND, "images/background.png") \
+    X(ATLAS_SAHED,      "images/sahed.png") \
+    X(ATLAS_GEPARD,     "images/gepard.png") \
+    X(ATLAS_FLAG_GB,    "images/gb.jpg") \
+    X(ATLAS_FLAG_PL,    "images/pl.jpg") \
+    X(ATLAS_FLAG_UA,    "images/ua.jpg") \
+    X(ATLAS_SOLID,      NULL)
+
+#define ATLAS_ENUM_ENTRY(id, file) id,
+typedef enum {
+    ATLAS_SPRITES(ATLAS_ENUM_ENTRY)
+    ATLAS_SPRITE_COUNT
+} AtlasSprite;
+#undef ATLAS_ENUM_ENTRY
+
+#define ATLAS_MAX_SIZE 2048         // Largest texture every classroom GPU supports
+#define ATLAS_PADDING 2             // Empty pixels between sprites so filtering never bleeds
+#define ATLAS_SOLID_SIZE 8          // White block used by SetShapesTexture()
+
+#endif // ATLAS_H
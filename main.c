@@ -1,5 +1,9 @@
 #include "raylib.h"
+#include "rlgl.h"
+#include "sok_core.h"
 #include "localization.h"
+#include "atlas.h"
+#include "atlas_rects.h"      // Generated at build time by sok_atlas
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -9,59 +13,13 @@
 //------------------------------------------------------------------------------------
 // Constants
 //------------------------------------------------------------------------------------
-// Game configuration
-#define MAX_DRONES 15
-#define MAX_PROJECTILES 10
-#define INITIAL_AMMO 10
-
-// Gameplay constants
-#define SHOT_COST 2
-#define HIT_REWARD 3
-#define SCORE_CORRECT_HIT 10
-#define SCORE_WRONG_HIT -5
-#define MAX_AMMO 20
-
-// Physics constants
-#define DRONE_SPEED 70.0f
-#define PROJECTILE_SPEED 3000.0f
-#define DRONE_FALL_SPEED 150.0f
-#define DRONE_FALL_HORIZONTAL_MULTIPLIER 0.5f
-#define DRONE_MIN_SCALE 0.2f
-#define PROJECTILE_HIT_RADIUS 0.3f
-#define PROJECTILE_MAX_LIFETIME 2.0f
+// Gameplay, physics and layout constants live in sok_core.h
 
 // Sprite scaling constants
-#define DRONE_SCALE 2.0f        // Drone sprite scale (1.5 = 150%)
-#define GEPARD_SCALE 2.0f       // Gepard tank scale (2.0 = 200%)
-#define GEPARD_TEXTURE_SIZE 150 // Original Gepard texture size (150x150)
-#define DRONE_TEXTURE_SIZE 100  // Original drone texture size (100x100)
-
-// Screen and layout constants
-#define SCREEN_WIDTH 1107
-#define SCREEN_HEIGHT 694
-#define GROUND_LEVEL 394.0f
-#define GROUND_EXPLOSION_OFFSET 200.0f
-#define NEAR_GROUND_LEVEL 494.0f
-
-// Gepard barrel positions (as ratios of sprite size)
-#define GEPARD_BARREL_LEFT_X 0.67f
-#define GEPARD_BARREL_RIGHT_X 0.83f
-#define GEPARD_BARREL_Y 0.63f
-
-// Drone spawn constants
-#define DRONE_SPAWN_X 1200.0f
-#define DRONE_SPAWN_SPACING 150.0f
-#define DRONE_SPAWN_Y_MIN 80.0f
-#define DRONE_SPAWN_Y_RANGE 250.0f
-#define DRONE_MIN_COUNT 2
-#define DRONE_MAX_COUNT 2
-
-// Drone target offsets for dual barrels
-#define DRONE_TARGET_OFFSET 10.0f
+#define DRONE_MIN_SCALE 0.2f
 
 // Animation timing
 #define EXPLOSION_DURATION 0.3f
-#define FIRE_FRAME_DURATION 0.05f
 #define BLINK_FREQUENCY 10.0f
 
 // UI constants
@@ -90,89 +48,39 @@
 #define EQUATION_BREAKDOWN_SIZE 28.0f // Breakdown display (reduced from 36)
 #define SCORE_SIZE 28.0f           // Score/level display (reduced from 32)
 
-// Spawn timing
-#define SPAWN_INTERVAL 3.0f
-#define RESPAWN_DELAY 1.0f
-
 // Drone animation constants
 #define DRONE_FALL_START_Y 100.0f
 #define DRONE_FALL_END_Y GROUND_LEVEL
 #define DRONE_TEXT_OFFSET_X 95.0f
 #define DRONE_TEXT_OFFSET_Y 30.0f
-#define FAKE_DESTRUCTION_FRAME_DURATION 0.15f  // Duration per frame for fake destruction (cells 2-4)
-#define FAKE_DESTRUCTION_FALL_DISTANCE 200.0f  // How far fake shaheds fall during destruction
-#define EXPLOSION_FRAME_DURATION 0.08f         // Duration per frame for explosion (cells 6-10)
 
 // Projectile visual constants
 #define PROJECTILE_TRAIL_LENGTH 0.02f
 #define PROJECTILE_LINE_THICKNESS 3.0f
 #define PROJECTILE_DOT_RADIUS 2.0f
 
-// Off-screen boundaries
-#define OFF_SCREEN_LEFT -150.0f
-#define OFF_SCREEN_RIGHT 1200.0f
-#define OFF_SCREEN_TOP -10.0f
-#define OFF_SCREEN_BOTTOM 750.0f
-#define DRONE_LEFT_BOUNDARY 100.0f
-
-//------------------------------------------------------------------------------------
-// Types and Structures Definition
-//------------------------------------------------------------------------------------
-typedef enum {
-    DRONE_FLYING = 0,
-    DRONE_FAKE_DESTRUCTION, // Non-shahed drones show fake destruction (cells 2-4)
-    DRONE_EXPLODING,        // Real explosion animation (cells 6-10)
-    DRONE_FALLING,
-    DRONE_DEAD
-} DroneState;
-
-typedef struct Drone {
-    Vector2 position;
-    int answer;
-    bool isShahed;
-    DroneState state;
-    float animTimer;
-    float stateStartY;  // Y position when current state started (for fake destruction fall)
-    bool active;
-} Drone;
-
-typedef struct {
-    int turretIndex;    // 0-4, which turret position
-    float fireTimer;
-    bool isFiring;
-    int fireFrame;      // 0 = bottom, 1 = middle, 2 = top
-} GepardTank;
+// Performance HUD
+#define PERF_HISTORY_FRAMES 120     // Frames shown in the rolling graph
+#define PERF_GRAPH_MS_HEIGHT 3.0f   // Graph pixels per millisecond
+#define PERF_GRAPH_MAX_MS 40.0f     // Bars are clipped above this
 
-typedef enum {
-    PART_NORMAL = 0,    // Normal display (blue)
-    PART_CANCELLED,     // Cancelled pairs (red)
-    PART_HIGHLIGHT      // Highlighted tens in addition (green)
-} PartVisualState;
+// Instanced drone drawing
+#define DRONE_INSTANCING_MIN 64     // Fewer drones go through the batch, the extra flush would cost more
 
-typedef struct {
-    int value;
-    char operatorBefore; // '+', '-', or '\0' for first element
-    PartVisualState visualState;
-} DecomposedPart;
+// Answer label cache
+#define LABEL_CACHE_SLOTS 4096      // Power of two, cleared once half of it is in use
+#define LABEL_MAX_GLYPHS 12         // Longest label text ("-2147483648")
 
-typedef struct {
-    int num1;
-    int num2;
-    char operation;
-    int correctAnswer;
-    char decomposed[128]; // String representation of decomposed equation
-    DecomposedPart parts[20]; // Individual parts for visual rendering
-    int partCount;
-} MathEquation;
+// Time warp
+#define WARP_MAX_SPEED 1024         // Highest capped speed, '+' beyond it runs uncapped
+#define WARP_FRAME_BUDGET 0.012     // Seconds of simulation per frame when warping (uncapped runs this long)
 
-typedef struct {
-    Vector2 position;
-    Vector2 velocity;
-    bool active;
-    float lifetime;
-    int targetDroneIndex;
-} Projectile;
+// Soak test
+#define SOAK_BUDGET_TOLERANCE 1.1   // Frames up to 10% over the target interval are on budget (timer jitter)
 
+//------------------------------------------------------------------------------------
+// Types and Structures Definition
+//------------------------------------------------------------------------------------
 // Helper structures for reducing redundant calculations
 typedef struct {
     float scale;
@@ -183,67 +91,272 @@ typedef struct {
     Vector2 mousePos;
 } RenderContext;
 
-typedef struct {
-    float width;
-    float height;
-    Vector2 center;
-    Rectangle bounds;
-} DroneBounds;
-
-typedef struct {
-    bool shahedFound;
-    bool canWin;
-    int aliveCount;
-} DroneStatus;
+// Main loop phases timed by the performance HUD
+typedef enum {
+    PERF_PHASE_INPUT = 0,   // Input handling and menus
+    PERF_PHASE_UPDATE,      // Simulation steps
+    PERF_PHASE_RENDER,      // Drawing the scene into the render texture
+    PERF_PHASE_BLIT,        // Scaled blit to the window (and the HUD itself)
+    PERF_PHASE_PRESENT,     // EndDrawing: batch flush, buffer swap and FPS cap wait
+    PERF_PHASE_COUNT
+} PerfPhase;
+
+// Rolling per-phase frame timing, toggled with F3. While shown, the HUD owns the active
+// rlgl render batch so it can count the draw calls submitted at each flush point.
+typedef struct PerfHud {
+    bool visible;
+    PerfPhase phase;                    // Phase being timed
+    uint64_t phaseStart;
+    float phaseMs[PERF_HISTORY_FRAMES][PERF_PHASE_COUNT];
+    int head;                           // History slot of the current frame
+    int frameCount;                     // Filled history slots
+    int drawCalls;                      // Draw calls of the current frame so far
+    int lastDrawCalls;                  // Draw calls of the last complete frame
+    bool batchLoaded;                   // The batch is loaded the first time the HUD is shown
+    rlRenderBatch batch;
+} PerfHud;
+
+// Draws every drone with one instanced call: a unit quad plus per-drone destination
+// and atlas UV rectangles. Needs OpenGL 3.3 or ES 3.0 (Mesa's llvmpipe qualifies),
+// 'supported' stays false elsewhere and drones are drawn one by one through the batch.
+typedef struct DroneInstancing {
+    bool supported;
+    bool enabled;                       // F7 (or --no-instancing) switches to the batched path
+    Shader shader;
+    int projectionLoc;
+    int modelviewLoc;
+    unsigned int vao;
+    unsigned int cornerBuffer;
+    unsigned int destBuffer;
+    unsigned int sourceBuffer;
+    Rectangle dest[MAX_DRONES];         // Per-instance data, uploaded every frame
+    Rectangle source[MAX_DRONES];
+} DroneInstancing;
+
+// Drone answer label with its glyphs already looked up and placed. A drone's answer
+// never changes, so the label is laid out the first time it shows up and then reused.
+typedef struct AnswerLabel {
+    bool used;
+    unsigned int fontId;                // Key: font texture, size, spacing and answer
+    float fontSize;
+    float spacing;
+    int answer;
+    Vector2 size;                       // As MeasureTextEx() reports it
+    int glyphCount;
+    int glyphIndex[LABEL_MAX_GLYPHS];   // Index into the font's glyphs and recs
+    float glyphX[LABEL_MAX_GLYPHS];     // Pen position of each glyph, relative to the label
+} AnswerLabel;
+
+// Open addressing table of answer labels
+typedef struct LabelCache {
+    int count;
+    AnswerLabel labels[LABEL_CACHE_SLOTS];
+} LabelCache;
+
+// Static screens kept in their own render texture
+typedef enum {
+    UI_SCREEN_LEVEL_SELECT = 0,
+    UI_SCREEN_OPTIONS,          // Overlay, drawn over the sky or the paused game
+    UI_SCREEN_PAUSE,            // Overlay, drawn over the game
+    UI_SCREEN_COUNT
+} UiScreen;
+
+// Everything the static screens show that can change, any difference re-renders them
+typedef struct UiState {
+    Language language;
+    bool showEquationBreakdown;
+    bool allowNegativeResults;
+    float musicVolume;
+} UiState;
+
+// Retained menus: each screen is drawn into its render texture when what it shows
+// changes, every other frame it is one textured quad instead of dozens of text layouts.
+// The screens are laid out at the virtual resolution, so resizing the window (which
+// only scales the final blit) leaves them valid.
+typedef struct UiLayer {
+    int width;
+    int height;
+    Font titleFont;
+    Font textFont;
+    Texture2D atlas;
+    RenderTexture2D screens[UI_SCREEN_COUNT];
+    bool valid[UI_SCREEN_COUNT];
+    UiState drawnState[UI_SCREEN_COUNT];    // State each screen was last rendered with
+} UiLayer;
+
+// What the render texture shows on a frame where nothing moves (a menu, or the game
+// paused). While it stays the same, the frame already there is shown again as is.
+typedef struct IdleFrame {
+    bool levelSelected;
+    bool showOptionsMenu;
+    bool paused;
+    bool gameStarted;
+    bool renderGame;
+    UiState ui;
+} IdleFrame;
 
 //------------------------------------------------------------------------------------
 // Function Declarations
 //------------------------------------------------------------------------------------
-// Game logic functions
-void DecomposeNumber(int num, int *tens, int *ones);
-void CreateDecomposedEquation(MathEquation *eq);
-void GenerateNewEquation(MathEquation *eq, int level, Drone drones[], bool allowNegative);
-void SpawnDrones(Drone drones[], MathEquation *eq, int *activeDroneCount);
-void UpdateDrones(Drone drones[], float deltaTime);
-void UpdateGepard(GepardTank *gepard, float deltaTime);
-void UpdateProjectiles(Projectile projectiles[], Drone drones[], int *ammo, int *score, bool *shahedActive, float deltaTime, Sound explosionSound);
-void SpawnProjectile(Projectile projectiles[], Vector2 start, Vector2 target, int droneIndex);
-int GetTurretIndexFromMouse(int mouseX, int screenWidth);
-
 // Drawing functions
-void DrawDrone(Texture2D texture, Drone drone);
-void DrawGepard(Texture2D texture, GepardTank gepard, Vector2 position);
+void DrawAtlasSprite(Texture2D atlas, AtlasSprite sprite, Rectangle source, Rectangle dest, Color tint);
+bool GetDroneSprite(Drone drone, Rectangle *source, Rectangle *dest);
+void DrawDrone(Texture2D atlas, Drone drone);
+void DrawGepard(Texture2D atlas, GepardTank gepard, Vector2 position);
 void DrawAmmo(int ammo, int screenWidth, int screenHeight);
-void DrawProjectiles(Projectile projectiles[]);
+void DrawProjectiles(const ProjectilePool *projectiles, float alpha);
 void DrawDecomposedEquation(MathEquation *eq, Font font, Vector2 position, float fontSize, float spacing, float blinkTimer);
 
+// Answer label functions
+const AnswerLabel *GetAnswerLabel(LabelCache *cache, Font font, int answer, float fontSize, float spacing);
+void DrawAnswerLabel(Font font, const AnswerLabel *label, Vector2 position, Color tint);
+
+// Instanced drone drawing functions
+void InitDroneInstancing(DroneInstancing *instancing);
+void UnloadDroneInstancing(DroneInstancing *instancing);
+bool IsDroneInstancingUsed(const DroneInstancing *instancing, int droneCount);
+int DrawDroneInstances(DroneInstancing *instancing, Texture2D atlas, const DronePool *drones, float alpha);
+
+// Retained menu functions
+void InitUiLayer(UiLayer *ui, int width, int height, Font titleFont, Font textFont, Texture2D atlas);
+void UnloadUiLayer(UiLayer *ui);
+void UpdateUiScreen(UiLayer *ui, UiScreen screen, UiState state);
+void DrawUiScreen(const UiLayer *ui, UiScreen screen);
+
 // Helper functions to reduce redundant calculations
 RenderContext CalculateRenderContext(int screenWidth, int screenHeight);
-DroneBounds GetDroneBounds(Drone drone);
-DroneStatus CheckDroneStatus(Drone drones[]);
-Vector2 GetBarrelPosition(Vector2 gepardPos, bool isLeftBarrel);
+void CloseSession(ReplayFile *replay, const char *traceFile);
+bool IsSameIdleFrame(IdleFrame a, IdleFrame b);
+
+// Performance HUD functions
+void InitPerfHud(PerfHud *hud);
+void UnloadPerfHud(PerfHud *hud);
+void SetPerfHudVisible(PerfHud *hud, bool visible);
+void BeginPerfFrame(PerfHud *hud);
+void MarkPerfPhase(PerfHud *hud, PerfPhase next);
+void CountPerfDrawCalls(PerfHud *hud);
+void EndPerfFrame(PerfHud *hud);
+void DrawPerfHud(const PerfHud *hud, const GameState *game);
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char *argv[])
 {
     // Initialization
     //--------------------------------------------------------------------------------------
     const int screenWidth = SCREEN_WIDTH;
     const int screenHeight = SCREEN_HEIGHT;
 
+    // Command line options
+    bool fixedTimestep = true;  // Simulate at SIM_TICK_RATE and interpolate rendering
+    int targetFPS = 60;         // Render rate cap (lower it on weak machines)
+    int stressDrones = 0;       // Drones per wave in stress mode (0 = normal game)
+    DistractorMode distractorMode = DISTRACTORS_NEARBY;
+    uint64_t seed = (uint64_t)time(NULL);   // Pass --seed to replay the same session
+    const char *recordFile = NULL;  // Record every simulation step to this replay file
+    const char *replayFile = NULL;  // Drive the simulation from this replay file
+    const char *traceFile = "sok_trace.json";   // F4 (or --trace) capture is written here
+    bool traceFromStart = false;    // Capture startup and asset loading too
+    double soakDuration = 0.0;      // Play automatically for this many seconds, then report (0 = off)
+    bool botPlaying = false;        // The bot player takes the mouse (always on in soak tests)
+    float botAccuracy = BOT_DEFAULT_ACCURACY;
+    float botReaction = BOT_DEFAULT_REACTION_TIME;
+    int timeWarp = 1;               // Simulation speed multiplier, 0 = uncapped (fixed step only)
+    bool renderGame = true;         // Off skips drawing the game (F6), for fast-forwarding
+    bool droneInstancing = true;    // Draw large drone counts with one instanced call (F7)
+    bool idleWaiting = true;        // Sleep until input on screens where nothing moves
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--variable-step") == 0) {
+            fixedTimestep = false;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            targetFPS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stress") == 0 && i + 1 < argc) {
+            stressDrones = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--distractors") == 0 && i + 1 < argc) {
+            i++;
+            distractorMode = (strcmp(argv[i], "plausible") == 0) ? DISTRACTORS_PLAUSIBLE : DISTRACTORS_NEARBY;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayFile = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            traceFile = argv[++i];
+            traceFromStart = true;
+        } else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            soakDuration = atof(argv[++i]);
+            botPlaying = true;
+        } else if (strcmp(argv[i], "--bot") == 0) {
+            botPlaying = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') botAccuracy = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--bot-reaction") == 0 && i + 1 < argc) {
+            botReaction = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            i++;
+            timeWarp = (strcmp(argv[i], "max") == 0) ? 0 : atoi(argv[i]);
+            if (timeWarp != 0) timeWarp = (timeWarp < 1) ? 1 : (timeWarp > WARP_MAX_SPEED) ? WARP_MAX_SPEED : timeWarp;
+        } else if (strcmp(argv[i], "--no-render") == 0) {
+            renderGame = false;
+        } else if (strcmp(argv[i], "--no-instancing") == 0) {
+            droneInstancing = false;
+        } else if (strcmp(argv[i], "--no-idle-wait") == 0) {
+            idleWaiting = false;
+        } else {
+            printf("Usage: %s [--variable-step] [--fps N] [--stress DRONES_PER_WAVE] [--distractors nearby|plausible] [--seed N] [--record FILE | --replay FILE] [--trace FILE] [--soak SECONDS] [--bot [ACCURACY]] [--bot-reaction SECONDS] [--speed N|max] [--no-render] [--no-instancing] [--no-idle-wait]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // A replay brings its own seed and settings
+    ReplayFile replay = { 0 };
+    bool replaying = (replayFile != NULL);
+    if (replaying) {
+        if (!OpenReplay(&replay, replayFile)) {
+            printf("Could not open replay file %s\n", replayFile);
+            return 1;
+        }
+        seed = replay.seed;
+    }
+
+    if (traceFromStart) BeginTraceCapture();
+
+    TRACE_ZONE_BEGIN(windowZone, "InitWindow");
     InitWindow(screenWidth, screenHeight, "Sky Over Kharkiv");
     InitAudioDevice();
-    SetTargetFPS(60);
+    SetTargetFPS(targetFPS);
     SetWindowState(FLAG_WINDOW_RESIZABLE);
     SetMasterVolume(0.5f); // Initialize with default volume
-
-    // Seed random
-    srand(time(NULL));
+    TRACE_ZONE_END(windowZone);
+
+    BotPlayer bot;
+    InitBotPlayer(&bot, botAccuracy, botReaction, seed);
+
+    // Print the seed so any session can be reproduced with --seed
+    printf("Seed: %llu\n", (unsigned long long)seed);
+
+    // Soak tests also run on machines without a display, on the simulation alone
+    static SoakTest soak;
+    double soakBudget = SOAK_BUDGET_TOLERANCE/((targetFPS > 0) ? targetFPS : 60);
+    if ((soakDuration > 0.0) && !IsWindowReady()) {
+        printf("No display available, running the soak test headless\n");
+        static GameState headlessGame;
+        InitGameState(&headlessGame, seed);
+        headlessGame.dronesPerWave = stressDrones;
+        headlessGame.distractorMode = distractorMode;
+        BeginSoakTest(&soak, soakDuration, soakBudget);
+        RunHeadlessSoak(&soak, &headlessGame, &bot);
+        PrintSoakReport(&soak);
+        UnloadGameState(&headlessGame);
+        CloseSession(&replay, traceFile);
+        return 0;
+    }
 
     // Initialize localization system (Polish as default)
+    TRACE_ZONE_BEGIN(localizationZone, "InitLocalization");
     InitLocalization("translations.ini", LANG_POLISH);
+    TRACE_ZONE_END(localizationZone);
 
     // Generate codepoint ranges for Latin + Cyrillic (for Ukrainian support)
     // Latin Basic: 0x0020-0x007F (95 chars)
@@ -264,6 +377,7 @@ int main(void)
 
     // Load TTF fonts from ari-w9500 family with Unicode support for Ukrainian
     // Loading multiple sizes for different uses to minimize scaling and maximize sharpness
+    TRACE_ZONE_BEGIN(fontZone, "LoadFonts");
     Font titleFont = LoadFontEx("fonts/ari-w9500-display.ttf", 72, codepoints, codepointCount);  // Large display titles
     Font menuFont = LoadFontEx("fonts/ari-w9500.ttf", 64, codepoints, codepointCount);           // Menu text (large)
     Font boldFont = LoadFontEx("fonts/ari-w9500-bold.ttf", 48, codepoints, codepointCount);      // Bold emphasis
@@ -272,6 +386,7 @@ int main(void)
 
     // Free codepoint array after loading fonts
     free(codepoints);
+    TRACE_ZONE_END(fontZone);
 
     // Map to existing font variables for compatibility
     Font mechaFont = titleFont;       // Used for titles and UI elements
@@ -303,70 +418,134 @@ int main(void)
         SetTextureFilter(equationFont.texture, TEXTURE_FILTER_BILINEAR);
     }
 
-    // Load textures
-    Texture2D sahedTexture = LoadTexture("images/sahed.png");
-    Texture2D gepardTexture = LoadTexture("images/gepard.png");
-    Texture2D backgroundTexture = LoadTexture("images/background.png");
-
-    // Load flag textures for language selection
-    Texture2D flagGB = LoadTexture("images/gb.jpg");
-    Texture2D flagPL = LoadTexture("images/pl.jpg");
-    Texture2D flagUA = LoadTexture("images/ua.jpg");
+    // Load the texture atlas (sprites, flags and the block shapes are drawn with), so
+    // only text switches textures within a frame
+    TRACE_ZONE_BEGIN(textureZone, "LoadTextures");
+    Texture2D atlasTexture = LoadTexture("images/atlas.png");
+    Rectangle solidRect = atlasRects[ATLAS_SOLID];
+    SetShapesTexture(atlasTexture, (Rectangle){ solidRect.x + 1, solidRect.y + 1, solidRect.width - 2, solidRect.height - 2 });
+    TRACE_ZONE_END(textureZone);
 
     // Load sounds
+    TRACE_ZONE_BEGIN(soundZone, "LoadSounds");
     Sound shootSound = LoadSound("sounds/fire_burst.wav");
     Sound explosionSound = LoadSound("sounds/explosion.wav");
+    TRACE_ZONE_END(soundZone);
 
     // Create render texture for scaling
     RenderTexture2D target = LoadRenderTexture(screenWidth, screenHeight);
     SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR);
 
-    // Game variables
-    GepardTank gepard = { 0, 0.0f, false, 0 };
-    Vector2 gepardPosition = { 120.0f, (float)screenHeight - 40.0f - (GEPARD_TEXTURE_SIZE * GEPARD_SCALE) };
-
-    Drone drones[MAX_DRONES] = {0};
-    int activeDroneCount = 0;
-
-    Projectile projectiles[MAX_PROJECTILES] = {0};
-
-    MathEquation currentEquation = {0};
-    int ammo = INITIAL_AMMO;
-    int score = 0;
-    int level = 1;
-    bool shahedActive = false; // Track if Shahed from current equation is still active
+    // Game variables (the whole simulation lives in the headless core)
+    static GameState game; // Too large for the stack with the full drone pool
+    if (replaying) {
+        InitGameFromReplay(&game, &replay);
+    } else {
+        InitGameState(&game, seed);
+        game.dronesPerWave = stressDrones;
+        game.distractorMode = distractorMode;
 
-    float spawnTimer = 0.0f;
+        if (recordFile != NULL && !BeginReplayRecording(&replay, recordFile, &game)) {
+            printf("Could not create replay file %s, not recording\n", recordFile);
+        }
+    }
 
     bool levelSelected = false;
-    bool gameStarted = false;
     bool paused = false;
     bool showOptionsMenu = false;
 
     // Options/Settings
     bool showEquationBreakdown = false; // Don't show decomposed equation by default
-    bool allowNegativeResults = false; // Don't allow negative results by default
     float musicVolume = 0.5f; // 0.0 to 1.0
 
+    // Fixed-step simulation state
+    float simAccumulator = 0.0f;    // Frame time not yet consumed by simulation steps
+    float renderAlpha = 1.0f;       // Interpolation factor between the last two steps
+    GameInput pendingInput = { 0 }; // Presses latched until the next simulation step
+    float replayClock = 0.0f;       // Frame time not yet consumed by replayed steps
+    if (!fixedTimestep) timeWarp = 1;   // Warping needs fixed steps
+
+    // Time warp statistics, for hunting rare slow steps
+    double simulatedTime = 0.0;     // Seconds of game time simulated so far
+    int frameSteps = 0;             // Steps run in the last frame
+    float slowestStepMs = 0.0f;
+    double slowestStepTime = 0.0;   // Simulated time at which the slowest step ran
+
+    static PerfHud perfHud;         // rlgl keeps a pointer to its render batch
+    InitPerfHud(&perfHud);
+
+    static LabelCache labelCache;       // Too large for the stack
+    static DroneInstancing instancing;  // Too large for the stack with the instance data
+    InitDroneInstancing(&instancing);
+    instancing.enabled = droneInstancing;
+
+    static UiLayer ui;                  // Menu screens, rendered once and reused
+    InitUiLayer(&ui, screenWidth, screenHeight, mechaFont, setbackFont, atlasTexture);
+
+    bool wasIdle = false;           // Last frame waited for input instead of running on
+    IdleFrame drawnFrame = { 0 };   // What the render texture holds
+    bool drawnFrameValid = false;
+
+    int botGames = 0;               // The bot goes through the levels in turn
+    if (soakDuration > 0.0) BeginSoakTest(&soak, soakDuration, soakBudget);
+
     //--------------------------------------------------------------------------------------
 
     // Main game loop
     while (!WindowShouldClose())
     {
         float deltaTime = GetFrameTime();
+        if (wasIdle) deltaTime = 0.0f;  // Time spent waiting for input is not game time
+        BeginPerfFrame(&perfHud);
+        if ((soakDuration > 0.0) && !UpdateSoakTest(&soak)) break;
+        TRACE_ZONE_BEGIN(frameZone, "Frame");
 
         // Update
         //----------------------------------------------------------------------------------
+        TRACE_ZONE_BEGIN(updateZone, "Update");
 
         // Fullscreen toggle with F key
         if (IsKeyPressed(KEY_F)) {
             ToggleBorderlessWindowed();
         }
 
+        // Performance HUD toggle with F3
+        if (IsKeyPressed(KEY_F3)) {
+            SetPerfHudVisible(&perfHud, !perfHud.visible);
+        }
+
+        // Time warp with +/- (fixed step only), F6 toggles drawing the game
+        if (fixedTimestep && IsKeyPressed(KEY_EQUAL) && timeWarp != 0) {
+            timeWarp = (timeWarp < WARP_MAX_SPEED) ? timeWarp*2 : 0;
+        }
+        if (fixedTimestep && IsKeyPressed(KEY_MINUS) && timeWarp != 1) {
+            timeWarp = (timeWarp == 0) ? WARP_MAX_SPEED : timeWarp/2;
+        }
+        if (IsKeyPressed(KEY_F6)) {
+            renderGame = !renderGame;
+        }
+
+        // Instanced drone drawing toggle with F7, to compare against the batched path
+        if (IsKeyPressed(KEY_F7)) {
+            instancing.enabled = !instancing.enabled;
+        }
+
+        // Trace capture toggle with F4, the trace is written when it stops
+        if (IsKeyPressed(KEY_F4)) {
+            if (!IsTraceCapturing()) {
+                BeginTraceCapture();
+                printf("Trace capture started\n");
+            } else if (EndTraceCapture(traceFile)) {
+                printf("Trace written to %s\n", traceFile);
+            } else {
+                printf("Could not write trace file %s\n", traceFile);
+            }
+        }
+
         // Options menu toggle with O key
         if (IsKeyPressed(KEY_O)) {
             showOptionsMenu = !showOptionsMenu;
-            if (showOptionsMenu && gameStarted) {
+            if (showOptionsMenu && game.gameStarted) {
                 paused = true; // Auto-pause when opening options during game
             }
         }
@@ -397,22 +576,21 @@ int main(void)
                 }
             }
 
+            int selectedLevel = 0;
             if (IsKeyPressed(KEY_ONE)) {
-                level = 1;
-                levelSelected = true;
+                selectedLevel = 1;
             } else if (IsKeyPressed(KEY_TWO)) {
-                level = 2;
-                levelSelected = true;
+                selectedLevel = 2;
             } else if (IsKeyPressed(KEY_THREE)) {
-                level = 3;
-                levelSelected = true;
+                selectedLevel = 3;
             }
 
-            if (levelSelected) {
-                gameStarted = true;
-                GenerateNewEquation(&currentEquation, level, drones, allowNegativeResults);
-                SpawnDrones(drones, &currentEquation, &activeDroneCount);
-                shahedActive = true;
+            if (botPlaying && selectedLevel == 0) selectedLevel = botGames++%3 + 1;
+
+            if (selectedLevel != 0 && !replaying) {
+                levelSelected = true;
+                StartGame(&game, selectedLevel);
+                RecordReplayStart(&replay, selectedLevel);
             }
         }
 
@@ -433,8 +611,9 @@ int main(void)
                     showEquationBreakdown = !showEquationBreakdown;
                 }
                 // Allow negative results toggle
-                if (CheckCollisionPointRec(ctx.mousePos, negativeCheckbox)) {
-                    allowNegativeResults = !allowNegativeResults;
+                if (CheckCollisionPointRec(ctx.mousePos, negativeCheckbox) && !replaying) {
+                    game.allowNegativeResults = !game.allowNegativeResults;
+                    RecordReplayOptions(&replay, game.allowNegativeResults);
                 }
             }
 
@@ -450,381 +629,267 @@ int main(void)
             }
         }
 
-        if (gameStarted) {
-            // Toggle pause (only when options menu is not shown and game is running)
-            if (!showOptionsMenu && IsKeyPressed(KEY_SPACE)) {
+        MarkPerfPhase(&perfHud, PERF_PHASE_UPDATE);
+
+        if (replaying) {
+            // Play the recording back in real time, space pauses it
+            if (levelSelected && !showOptionsMenu && IsKeyPressed(KEY_SPACE)) {
                 paused = !paused;
             }
 
             if (!paused && !showOptionsMenu) {
-                // Calculate render context once per frame (eliminates duplicate calculations)
-                RenderContext ctx = CalculateRenderContext(screenWidth, screenHeight);
-
-                gepard.turretIndex = GetTurretIndexFromMouse(ctx.mousePos.x, screenWidth);
-
-                // Update gepard animation
-                UpdateGepard(&gepard, deltaTime);
+                unsigned int frameEvents = 0;
+                float stepTime = SIM_FIXED_DT;
+                int steps = 0;
+                ReplayRecord record;
+                uint64_t warpDeadline = GetClockNanoseconds() + (uint64_t)(WARP_FRAME_BUDGET*1e9);
+
+                replayClock += deltaTime*((timeWarp > 0) ? timeWarp : 1);
+                while (replayClock > 0.0f || timeWarp == 0) {
+                    if (!PlayReplayRecord(&replay, &game, &record)) {
+                        // End of the recording, the player takes over from here
+                        if (replay.firstMismatch != 0) {
+                            printf("Replay diverged from the recording at step %u of %u\n", replay.firstMismatch, replay.stepCount);
+                        } else {
+                            printf("Replay matched the recording (%u steps)\n", replay.stepCount);
+                        }
+                        CloseReplay(&replay);
+                        replaying = false;
+                        replayClock = 0.0f;
+                        break;
+                    }
 
-                // Update drones
-                UpdateDrones(drones, deltaTime);
+                    if (record.type == REPLAY_RECORD_START) {
+                        levelSelected = true;
+                    } else if (record.type == REPLAY_RECORD_STEP) {
+                        frameEvents |= game.events;
+                        stepTime = record.deltaTime;
+                        replayClock -= record.deltaTime;
+
+                        // Give up on time we can't catch up with, like live play does
+                        steps++;
+                        if ((timeWarp > 0 && steps >= MAX_SIM_STEPS_PER_FRAME*timeWarp) ||
+                            (timeWarp != 1 && GetClockNanoseconds() >= warpDeadline)) {
+                            if (replayClock > 0.0f) replayClock = 0.0f;
+                            break;
+                        }
+                    }
+                }
 
-                // Update projectiles
-                UpdateProjectiles(projectiles, drones, &ammo, &score, &shahedActive, deltaTime, explosionSound);
+                frameSteps = steps;
 
-                // Spawn timer
-                spawnTimer += deltaTime;
+                // The last step ran up to -replayClock ahead of the frame
+                if (timeWarp == 0) replayClock = 0.0f;
+                renderAlpha = (stepTime > 0.0f) ? 1.0f + replayClock / stepTime : 1.0f;
+                if (renderAlpha < 0.0f) renderAlpha = 0.0f;
 
-                // Check drone status (replaces duplicate logic)
-                DroneStatus droneStatus = CheckDroneStatus(drones);
+                if (frameEvents & GAME_EVENT_SHOT) PlaySound(shootSound);
+                if (frameEvents & GAME_EVENT_EXPLOSION) PlaySound(explosionSound);
 
-                // Update shahedActive status
-                if (!droneStatus.shahedFound) {
-                    shahedActive = false;
+                if (levelSelected && !game.gameStarted) {
+                    levelSelected = false;
+                    paused = false;
                 }
+            }
+        } else if (game.gameStarted) {
+            // Toggle pause (only when options menu is not shown and game is running)
+            if (!showOptionsMenu && IsKeyPressed(KEY_SPACE)) {
+                paused = !paused;
+            }
 
-                // Spawn new wave only if Shahed has been dealt with (hit or missed)
-                if (!shahedActive && spawnTimer > RESPAWN_DELAY) {
-                    GenerateNewEquation(&currentEquation, level, drones, allowNegativeResults);
-                    SpawnDrones(drones, &currentEquation, &activeDroneCount);
-                    shahedActive = true;
-                    spawnTimer = 0.0f;
-                }
+            if (!paused && !showOptionsMenu) {
+                // Calculate render context once per frame (eliminates duplicate calculations)
+                RenderContext ctx = CalculateRenderContext(screenWidth, screenHeight);
 
-                // Handle shooting
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !gepard.isFiring && ammo >= SHOT_COST) {
-                    // Check if clicked on a drone
-                    for (int i = 0; i < MAX_DRONES; i++) {
-                        if (drones[i].active && drones[i].state == DRONE_FLYING) {
-                            DroneBounds bounds = GetDroneBounds(drones[i]);
-                            if (CheckCollisionPointRec(ctx.mousePos, bounds.bounds)) {
-                                // Fire at drone
-                                ammo -= SHOT_COST;
-                                gepard.isFiring = true;
-                                gepard.fireTimer = 0.0f;
-                                gepard.fireFrame = 1; // Start at middle frame for immediate visual feedback
-                                PlaySound(shootSound);
-                                // Play explosion sound only if hitting the correct drone (Shahed)
-                                if (drones[i].isShahed) {
-                                    PlaySound(explosionSound);
-                                }
-
-                                // Spawn THREE projectiles from tank to drone (dual barrels + center)
-                                Vector2 barrelPos1 = GetBarrelPosition(gepardPosition, true);
-                                Vector2 barrelPos2 = GetBarrelPosition(gepardPosition, false);
-                                Vector2 barrelPosCenter = {
-                                    (barrelPos1.x + barrelPos2.x) / 2.0f,
-                                    (barrelPos1.y + barrelPos2.y) / 2.0f
-                                };
-
-                                // Target center of drone with slight offset for triple barrels
-                                Vector2 droneTarget1 = { bounds.center.x - DRONE_TARGET_OFFSET, bounds.center.y };
-                                Vector2 droneTarget2 = { bounds.center.x + DRONE_TARGET_OFFSET, bounds.center.y };
-                                Vector2 droneTarget3 = { bounds.center.x, bounds.center.y };
-                                SpawnProjectile(projectiles, barrelPos1, droneTarget1, i);
-                                SpawnProjectile(projectiles, barrelPos2, droneTarget2, i);
-                                SpawnProjectile(projectiles, barrelPosCenter, droneTarget3, i);
-                                break;
-                            }
+                // Latch presses so a frame that runs no simulation step does not lose them
+                pendingInput.mousePos = ctx.mousePos;
+                pendingInput.firePressed |= IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+                pendingInput.restartPressed |= IsKeyPressed(KEY_R);
+
+                unsigned int frameEvents = 0;
+                if (fixedTimestep) {
+                    // Warped frames run timeWarp frames' worth of steps (uncapped: as many as
+                    // fit in the frame budget), the bot plays every step as it would at 1x
+                    uint64_t warpDeadline = GetClockNanoseconds() + (uint64_t)(WARP_FRAME_BUDGET*1e9);
+                    simAccumulator += deltaTime*((timeWarp > 0) ? timeWarp : 1);
+                    frameSteps = 0;
+                    while ((simAccumulator >= SIM_FIXED_DT || timeWarp == 0) && game.gameStarted) {
+                        // The bot's shots take the same path as mouse clicks
+                        GameInput stepInput = botPlaying ? UpdateBotPlayer(&bot, &game, SIM_FIXED_DT) : pendingInput;
+
+                        uint64_t stepStart = GetClockNanoseconds();
+                        StepGame(&game, &stepInput, SIM_FIXED_DT);
+                        float stepMs = (GetClockNanoseconds() - stepStart)/1e6f;
+                        if (stepMs > slowestStepMs) {
+                            slowestStepMs = stepMs;
+                            slowestStepTime = simulatedTime;
+                            if (timeWarp != 1) printf("Slowest step so far: %.3f ms at game time %.2f s\n", stepMs, simulatedTime);
+                        }
+                        simulatedTime += SIM_FIXED_DT;
+
+                        RecordReplayStep(&replay, &stepInput, SIM_FIXED_DT, &game);
+                        frameEvents |= game.events;
+                        pendingInput.firePressed = false;
+                        pendingInput.restartPressed = false;
+                        simAccumulator -= SIM_FIXED_DT;
+
+                        // Give up on simulated time we can't catch up with after a long hitch
+                        frameSteps++;
+                        if ((timeWarp > 0 && frameSteps >= MAX_SIM_STEPS_PER_FRAME*timeWarp) ||
+                            (timeWarp != 1 && GetClockNanoseconds() >= warpDeadline)) {
+                            simAccumulator = 0.0f;
+                            break;
                         }
                     }
+                    if (simAccumulator < 0.0f) simAccumulator = 0.0f;
+                    renderAlpha = simAccumulator / SIM_FIXED_DT;
+                } else {
+                    GameInput stepInput = botPlaying ? UpdateBotPlayer(&bot, &game, deltaTime) : pendingInput;
+                    StepGame(&game, &stepInput, deltaTime);
+                    RecordReplayStep(&replay, &stepInput, deltaTime, &game);
+                    frameEvents = game.events;
+                    pendingInput.firePressed = false;
+                    pendingInput.restartPressed = false;
+                    renderAlpha = 1.0f;
                 }
 
-                // Game over check
-                if (ammo < SHOT_COST) {
-                    // Reuse the drone status we already calculated
-                    if (!droneStatus.canWin && droneStatus.aliveCount == 0) {
-                        // Game over - restart
-                        if (IsKeyPressed(KEY_R)) {
-                            ammo = INITIAL_AMMO;
-                            score = 0;
-                            levelSelected = false;
-                            gameStarted = false;
-                            shahedActive = false;
-                            paused = false;
-                            spawnTimer = 0.0f;
-
-                            // Clear all drones
-                            for (int i = 0; i < MAX_DRONES; i++) {
-                                drones[i].active = false;
-                            }
-                        }
-                    }
+                if (frameEvents & GAME_EVENT_SHOT) PlaySound(shootSound);
+                // Play explosion sound only if hitting the correct drone (Shahed)
+                if (frameEvents & GAME_EVENT_EXPLOSION) PlaySound(explosionSound);
+
+                // Restart after game over returns to level selection
+                if (!game.gameStarted) {
+                    levelSelected = false;
+                    paused = false;
+                    simAccumulator = 0.0f;
                 }
             }
         }
+        TRACE_ZONE_END(updateZone);
         //----------------------------------------------------------------------------------
 
         // Draw
         //----------------------------------------------------------------------------------
+        TRACE_ZONE_BEGIN(drawZone, "Draw");
+
+        MarkPerfPhase(&perfHud, PERF_PHASE_RENDER);
+
+        // Nothing moves on the menus or while paused: the loop then sleeps until input
+        // arrives, and keeps the last frame unless the input changed what it shows
+        bool idle = idleWaiting && !perfHud.visible && !botPlaying && !IsTraceCapturing() &&
+                    (replaying ? (paused || showOptionsMenu) : (!game.gameStarted || paused || showOptionsMenu));
+        UiState uiState = { GetCurrentLanguage(), showEquationBreakdown, game.allowNegativeResults, musicVolume };
+        IdleFrame idleFrame = { levelSelected, showOptionsMenu, paused, game.gameStarted, renderGame, uiState };
+        bool reuseFrame = idle && drawnFrameValid && IsSameIdleFrame(idleFrame, drawnFrame);
+
+        // Bring the menu screens shown this frame up to date (a no-op unless the language
+        // or a setting changed since they were last rendered)
+        if (renderGame && !reuseFrame) {
+            if (!levelSelected && !showOptionsMenu) UpdateUiScreen(&ui, UI_SCREEN_LEVEL_SELECT, uiState);
+            if (showOptionsMenu) UpdateUiScreen(&ui, UI_SCREEN_OPTIONS, uiState);
+            if (game.gameStarted && paused && !showOptionsMenu) UpdateUiScreen(&ui, UI_SCREEN_PAUSE, uiState);
+        }
 
-        // Render game to texture at native resolution
-        BeginTextureMode(target);
-
-            ClearBackground(BLACK);
-
-            if (!levelSelected && !showOptionsMenu) {
-                // Level selection screen - using Setback font
-                ClearBackground((Color){135, 206, 235, 255}); // Sky blue for menu
-
-                // Measure and center title
-                Vector2 titleSize = MeasureTextEx(setbackFont, GetText(STR_GAME_TITLE), TITLE_SIZE_LARGE, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_GAME_TITLE), (Vector2){screenWidth/2 - titleSize.x/2, screenHeight/2 - 120}, TITLE_SIZE_LARGE, SETBACK_SPACING, BLACK);
-
-                Vector2 subtitleSize = MeasureTextEx(setbackFont, GetText(STR_GAME_SUBTITLE), TITLE_SIZE_MEDIUM, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_GAME_SUBTITLE), (Vector2){screenWidth/2 - subtitleSize.x/2, screenHeight/2 - 60}, TITLE_SIZE_MEDIUM, SETBACK_SPACING, DARKGRAY);
-
-                Vector2 instructionsSize = MeasureTextEx(setbackFont, GetText(STR_GAME_INSTRUCTIONS), TEXT_SIZE_LARGE, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_GAME_INSTRUCTIONS), (Vector2){screenWidth/2 - instructionsSize.x/2, screenHeight/2 - 30}, TEXT_SIZE_LARGE, SETBACK_SPACING, DARKGRAY);
-
-                Vector2 selectLevelSize = MeasureTextEx(setbackFont, GetText(STR_SELECT_LEVEL), TEXT_SIZE_LARGE, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_SELECT_LEVEL), (Vector2){screenWidth/2 - selectLevelSize.x/2, screenHeight/2 + 20}, TEXT_SIZE_LARGE, SETBACK_SPACING, BLACK);
-
-                Vector2 level1Size = MeasureTextEx(setbackFont, GetText(STR_LEVEL_1_DESC), TEXT_SIZE_LARGE, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_LEVEL_1_DESC), (Vector2){screenWidth/2 - level1Size.x/2, screenHeight/2 + 60}, TEXT_SIZE_LARGE, SETBACK_SPACING, DARKGREEN);
-
-                Vector2 level2Size = MeasureTextEx(setbackFont, GetText(STR_LEVEL_2_DESC), TEXT_SIZE_LARGE, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_LEVEL_2_DESC), (Vector2){screenWidth/2 - level2Size.x/2, screenHeight/2 + 90}, TEXT_SIZE_LARGE, SETBACK_SPACING, ORANGE);
-
-                Vector2 level3Size = MeasureTextEx(setbackFont, GetText(STR_LEVEL_3_DESC), TEXT_SIZE_LARGE, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_LEVEL_3_DESC), (Vector2){screenWidth/2 - level3Size.x/2, screenHeight/2 + 120}, TEXT_SIZE_LARGE, SETBACK_SPACING, RED);
-
-                // Options hint
-                Vector2 optionsSize = MeasureTextEx(setbackFont, GetText(STR_PRESS_OPTIONS), TEXT_SIZE_MEDIUM, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_PRESS_OPTIONS), (Vector2){screenWidth/2 - optionsSize.x/2, screenHeight/2 + 160}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, BLUE);
-
-                // Draw language selection flags at the bottom
-                const float flagSize = 60.0f;
-                const float flagSpacing = 20.0f;
-                const float flagY = screenHeight - 100.0f;
-                Language currentLang = GetCurrentLanguage();
-
-                // English flag (GB)
-                Rectangle flagDestGB = {screenWidth/2 - flagSize - flagSpacing - flagSize/2, flagY, flagSize, flagSize * 0.6f};
-                DrawTexturePro(flagGB,
-                              (Rectangle){0, 0, (float)flagGB.width, (float)flagGB.height},
-                              flagDestGB,
-                              (Vector2){0, 0}, 0.0f, WHITE);
-                if (currentLang == LANG_ENGLISH) {
-                    DrawRectangleLinesEx(flagDestGB, 3, GREEN);
-                } else {
-                    DrawRectangleLinesEx(flagDestGB, 2, BLACK);
-                }
-
-                // Polish flag (PL)
-                Rectangle flagDestPL = {screenWidth/2 - flagSize/2, flagY, flagSize, flagSize * 0.6f};
-                DrawTexturePro(flagPL,
-                              (Rectangle){0, 0, (float)flagPL.width, (float)flagPL.height},
-                              flagDestPL,
-                              (Vector2){0, 0}, 0.0f, WHITE);
-                if (currentLang == LANG_POLISH) {
-                    DrawRectangleLinesEx(flagDestPL, 3, GREEN);
-                } else {
-                    DrawRectangleLinesEx(flagDestPL, 2, BLACK);
-                }
-
-                // Ukrainian flag (UA)
-                Rectangle flagDestUA = {screenWidth/2 + flagSpacing + flagSize/2, flagY, flagSize, flagSize * 0.6f};
-                DrawTexturePro(flagUA,
-                              (Rectangle){0, 0, (float)flagUA.width, (float)flagUA.height},
-                              flagDestUA,
-                              (Vector2){0, 0}, 0.0f, WHITE);
-                if (currentLang == LANG_UKRAINIAN) {
-                    DrawRectangleLinesEx(flagDestUA, 3, GREEN);
-                } else {
-                    DrawRectangleLinesEx(flagDestUA, 2, BLACK);
-                }
-            } else if (showOptionsMenu) {
-                // Draw options menu on top of level selection
-                ClearBackground((Color){135, 206, 235, 255}); // Sky blue background
-
-                // Dark overlay
-                DrawRectangle(0, 0, screenWidth, screenHeight, (Color){0, 0, 0, 180});
-
-                // Menu title
-                Vector2 optionsTitleSize = MeasureTextEx(mechaFont, GetText(STR_OPTIONS), TITLE_SIZE_LARGE, MECHA_SPACING);
-                DrawTextEx(mechaFont, GetText(STR_OPTIONS), (Vector2){screenWidth/2 - optionsTitleSize.x/2, screenHeight/2 - 150}, TITLE_SIZE_LARGE, MECHA_SPACING, WHITE);
-
-                // Option 1: Show Equation Breakdown
-                DrawTextEx(setbackFont, GetText(STR_SHOW_BREAKDOWN), (Vector2){screenWidth/2 - 200, screenHeight/2 - 70}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
-
-                // Checkbox 1
-                Rectangle checkboxRect1 = {screenWidth/2 + 180, screenHeight/2 - 80, 30, 30};
-                DrawRectangleRec(checkboxRect1, WHITE);
-                DrawRectangleLinesEx(checkboxRect1, 2, BLACK);
-                if (showEquationBreakdown) {
-                    // Draw checkmark
-                    DrawRectangle(checkboxRect1.x + 5, checkboxRect1.y + 5, 20, 20, GREEN);
-                }
-
-                // Option 2: Allow Negative Results
-                DrawTextEx(setbackFont, GetText(STR_ALLOW_NEGATIVE), (Vector2){screenWidth/2 - 200, screenHeight/2 - 20}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
-
-                // Checkbox 2
-                Rectangle checkboxRect2 = {screenWidth/2 + 180, screenHeight/2 - 30, 30, 30};
-                DrawRectangleRec(checkboxRect2, WHITE);
-                DrawRectangleLinesEx(checkboxRect2, 2, BLACK);
-                if (allowNegativeResults) {
-                    // Draw checkmark
-                    DrawRectangle(checkboxRect2.x + 5, checkboxRect2.y + 5, 20, 20, GREEN);
-                }
-
-                // Option 3: Music Volume
-                DrawTextEx(setbackFont, GetText(STR_MUSIC_VOLUME), (Vector2){screenWidth/2 - 200, screenHeight/2 + 40}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
-
-                // Slider
-                Rectangle sliderBg = {screenWidth/2 - 100, screenHeight/2 + 50, 200, 20};
-                DrawRectangleRec(sliderBg, DARKGRAY);
-                DrawRectangleLinesEx(sliderBg, 2, WHITE);
-
-                // Slider fill
-                Rectangle sliderFill = {sliderBg.x, sliderBg.y, sliderBg.width * musicVolume, sliderBg.height};
-                DrawRectangleRec(sliderFill, SKYBLUE);
-
-                // Slider handle
-                float handleX = sliderBg.x + (sliderBg.width * musicVolume);
-                DrawCircle(handleX, sliderBg.y + sliderBg.height/2, 12, WHITE);
-                DrawCircleLines(handleX, sliderBg.y + sliderBg.height/2, 12, BLACK);
-
-                // Volume percentage
-                char volumeText[16];
-                sprintf(volumeText, "%d%%", (int)(musicVolume * 100));
-                DrawTextEx(setbackFont, volumeText, (Vector2){screenWidth/2 + 120, screenHeight/2 + 45}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
-
-                // Instructions
-                Vector2 closeSize = MeasureTextEx(setbackFont, GetText(STR_CLOSE_OPTIONS), TEXT_SIZE_MEDIUM, SETBACK_SPACING);
-                DrawTextEx(setbackFont, GetText(STR_CLOSE_OPTIONS), (Vector2){screenWidth/2 - closeSize.x/2, screenHeight/2 + 100}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, LIGHTGRAY);
-            } else if (gameStarted) {
-                // Draw background
-                DrawTexture(backgroundTexture, 0, 0, WHITE);
-
-                // Draw equation - using Pixantiqua font
-                char equationText[64];
-                sprintf(equationText, "%d %c %d = ?",
-                        currentEquation.num1, currentEquation.operation, currentEquation.num2);
-                DrawTextEx(pixantiquaFont, equationText, (Vector2){20, 20}, EQUATION_SIZE, PIXANTIQUA_SPACING, BLACK);
-
-                // Draw decomposed equation with color coding (if enabled)
-                if (showEquationBreakdown) {
-                    DrawDecomposedEquation(&currentEquation, pixantiquaFont, (Vector2){20, 60}, EQUATION_BREAKDOWN_SIZE, PIXANTIQUA_SPACING, 0.0f);
-                }
+        if (!reuseFrame) {
+            // Render game to texture at native resolution
+            BeginTextureMode(target);
+
+                ClearBackground(BLACK);
+
+                if (!renderGame) {
+                    // Fast-forwarding: nothing is drawn but the time warp status
+                } else if (!levelSelected && !showOptionsMenu) {
+                    DrawUiScreen(&ui, UI_SCREEN_LEVEL_SELECT);
+                } else if (showOptionsMenu) {
+                    // Draw options menu on top of level selection
+                    ClearBackground((Color){135, 206, 235, 255}); // Sky blue background
+                    DrawUiScreen(&ui, UI_SCREEN_OPTIONS);
+                } else if (game.gameStarted) {
+                    // Draw background
+                    Rectangle backgroundRect = atlasRects[ATLAS_BACKGROUND];
+                    DrawAtlasSprite(atlasTexture, ATLAS_BACKGROUND, (Rectangle){0, 0, backgroundRect.width, backgroundRect.height},
+                                    (Rectangle){0, 0, backgroundRect.width, backgroundRect.height}, WHITE);
+
+                    // Draw equation - using Pixantiqua font
+                    char equationText[64];
+                    sprintf(equationText, "%d %c %d = ?",
+                            game.currentEquation.num1, game.currentEquation.operation, game.currentEquation.num2);
+                    DrawTextEx(pixantiquaFont, equationText, (Vector2){20, 20}, EQUATION_SIZE, PIXANTIQUA_SPACING, BLACK);
+
+                    // Draw decomposed equation with color coding (if enabled)
+                    if (showEquationBreakdown) {
+                        DrawDecomposedEquation(&game.currentEquation, pixantiquaFont, (Vector2){20, 60}, EQUATION_BREAKDOWN_SIZE, PIXANTIQUA_SPACING, 0.0f);
+                    }
 
-                // Draw score and level - using Mecha font
-                char scoreText[64];
-                sprintf(scoreText, GetText(STR_SCORE), score);
-                DrawTextEx(mechaFont, scoreText, (Vector2){screenWidth - 180, 20}, SCORE_SIZE, MECHA_SPACING, BLACK);
+                    // Draw score and level - using Mecha font
+                    char scoreText[64];
+                    sprintf(scoreText, GetText(STR_SCORE), game.score);
+                    DrawTextEx(mechaFont, scoreText, (Vector2){screenWidth - 180, 20}, SCORE_SIZE, MECHA_SPACING, BLACK);
 
-                char levelText[64];
-                sprintf(levelText, GetText(STR_LEVEL), level);
-                DrawTextEx(mechaFont, levelText, (Vector2){screenWidth - 180, 60}, SCORE_SIZE, MECHA_SPACING, DARKBLUE);
+                    char levelText[64];
+                    sprintf(levelText, GetText(STR_LEVEL), game.level);
+                    DrawTextEx(mechaFont, levelText, (Vector2){screenWidth - 180, 60}, SCORE_SIZE, MECHA_SPACING, DARKBLUE);
 
-                // Draw drone sprites
-                for (int i = 0; i < MAX_DRONES; i++) {
-                    if (drones[i].active && drones[i].state != DRONE_DEAD) {
-                        DrawDrone(sahedTexture, drones[i]);
+                    // Draw drone sprites (interpolated between the last two simulation steps),
+                    // all in one instanced call when there are many
+                    if (IsDroneInstancingUsed(&instancing, game.drones.count)) {
+                        CountPerfDrawCalls(&perfHud);   // The instanced draw flushes the batch first
+                        if (DrawDroneInstances(&instancing, atlasTexture, &game.drones, renderAlpha) > 0) perfHud.drawCalls++;
+                    } else {
+                        for (int i = 0; i < game.drones.count; i++) {
+                            Drone drawn = GetDrone(&game.drones, i);
+                            drawn.position = InterpolatePosition(drawn.prevPosition, drawn.position, renderAlpha);
+                            DrawDrone(atlasTexture, drawn);
+                        }
                     }
-                }
 
-                // Draw all numbers on top (so they're never hidden by other drones) - using Pixantiqua font
-                if (!paused) {
-                    for (int i = 0; i < MAX_DRONES; i++) {
-                        if (drones[i].active && drones[i].state == DRONE_FLYING) {
-                            char answerText[16];
-                            sprintf(answerText, "%d", drones[i].answer);
-                            Vector2 textSize = MeasureTextEx(pixantiquaFont, answerText, EQUATION_SIZE, PIXANTIQUA_SPACING);
-                            Vector2 textPos = {drones[i].position.x + DRONE_TEXT_OFFSET_X - textSize.x/2,
-                                               drones[i].position.y + DRONE_TEXT_OFFSET_Y};
+                    // Draw all numbers on top (so they're never hidden by other drones) - using Pixantiqua font
+                    if (!paused) {
+                        for (int i = 0; i < game.drones.flyingCount; i++) {
+                            Drone drone = GetDrone(&game.drones, i);
+                            const AnswerLabel *label = GetAnswerLabel(&labelCache, pixantiquaFont, drone.answer, EQUATION_SIZE, PIXANTIQUA_SPACING);
+                            Vector2 dronePos = InterpolatePosition(drone.prevPosition, drone.position, renderAlpha);
+                            Vector2 textPos = {dronePos.x + DRONE_TEXT_OFFSET_X - label->size.x/2,
+                                               dronePos.y + DRONE_TEXT_OFFSET_Y};
                             // Draw red text
-                            DrawTextEx(pixantiquaFont, answerText, textPos, EQUATION_SIZE, PIXANTIQUA_SPACING, RED);
+                            DrawAnswerLabel(pixantiquaFont, label, textPos, RED);
                         }
                     }
-                }
-
-                // Draw Gepard tank
-                DrawGepard(gepardTexture, gepard, gepardPosition);
 
-                // Draw projectiles
-                DrawProjectiles(projectiles);
+                    // Draw Gepard tank
+                    DrawGepard(atlasTexture, game.gepard, game.gepardPosition);
 
-                // Draw ammo
-                DrawAmmo(ammo, screenWidth, screenHeight);
+                    // Draw projectiles
+                    DrawProjectiles(&game.projectiles, renderAlpha);
 
-                // Draw pause message - using Mecha font
-                if (paused && !showOptionsMenu) {
-                    DrawRectangle(0, 0, screenWidth, screenHeight, (Color){0, 0, 0, 128});
-                    Vector2 pausedSize = MeasureTextEx(mechaFont, GetText(STR_PAUSED), TITLE_SIZE_LARGE, MECHA_SPACING);
-                    DrawTextEx(mechaFont, GetText(STR_PAUSED), (Vector2){screenWidth/2 - pausedSize.x/2, screenHeight/2 - 40}, TITLE_SIZE_LARGE, MECHA_SPACING, WHITE);
-                    Vector2 resumeSize = MeasureTextEx(mechaFont, GetText(STR_PRESS_RESUME), SCORE_SIZE, MECHA_SPACING);
-                    DrawTextEx(mechaFont, GetText(STR_PRESS_RESUME), (Vector2){screenWidth/2 - resumeSize.x/2, screenHeight/2 + 20}, SCORE_SIZE, MECHA_SPACING, WHITE);
-                }
+                    // Draw ammo
+                    DrawAmmo(game.ammo, screenWidth, screenHeight);
 
-                // Draw options menu
-                if (showOptionsMenu) {
-                    // Dark overlay
-                    DrawRectangle(0, 0, screenWidth, screenHeight, (Color){0, 0, 0, 180});
-
-                    // Menu title
-                    Vector2 optionsTitleSize2 = MeasureTextEx(mechaFont, GetText(STR_OPTIONS), TITLE_SIZE_LARGE, MECHA_SPACING);
-                    DrawTextEx(mechaFont, GetText(STR_OPTIONS), (Vector2){screenWidth/2 - optionsTitleSize2.x/2, screenHeight/2 - 150}, TITLE_SIZE_LARGE, MECHA_SPACING, WHITE);
-
-                    // Option 1: Show Equation Breakdown
-                    DrawTextEx(setbackFont, GetText(STR_SHOW_BREAKDOWN), (Vector2){screenWidth/2 - 200, screenHeight/2 - 70}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
-
-                    // Checkbox 1
-                    Rectangle checkboxRect1 = {screenWidth/2 + 180, screenHeight/2 - 80, 30, 30};
-                    DrawRectangleRec(checkboxRect1, WHITE);
-                    DrawRectangleLinesEx(checkboxRect1, 2, BLACK);
-                    if (showEquationBreakdown) {
-                        // Draw checkmark
-                        DrawRectangle(checkboxRect1.x + 5, checkboxRect1.y + 5, 20, 20, GREEN);
+                    // Draw pause message
+                    if (paused && !showOptionsMenu) {
+                        DrawUiScreen(&ui, UI_SCREEN_PAUSE);
                     }
 
-                    // Option 2: Allow Negative Results
-                    DrawTextEx(setbackFont, GetText(STR_ALLOW_NEGATIVE), (Vector2){screenWidth/2 - 200, screenHeight/2 - 20}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
-
-                    // Checkbox 2
-                    Rectangle checkboxRect2 = {screenWidth/2 + 180, screenHeight/2 - 30, 30, 30};
-                    DrawRectangleRec(checkboxRect2, WHITE);
-                    DrawRectangleLinesEx(checkboxRect2, 2, BLACK);
-                    if (allowNegativeResults) {
-                        // Draw checkmark
-                        DrawRectangle(checkboxRect2.x + 5, checkboxRect2.y + 5, 20, 20, GREEN);
+                    // Draw options menu
+                    if (showOptionsMenu) {
+                        DrawUiScreen(&ui, UI_SCREEN_OPTIONS);
                     }
 
-                    // Option 3: Music Volume
-                    DrawTextEx(setbackFont, GetText(STR_MUSIC_VOLUME), (Vector2){screenWidth/2 - 200, screenHeight/2 + 40}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
-
-                    // Slider
-                    Rectangle sliderBg = {screenWidth/2 - 100, screenHeight/2 + 50, 200, 20};
-                    DrawRectangleRec(sliderBg, DARKGRAY);
-                    DrawRectangleLinesEx(sliderBg, 2, WHITE);
-
-                    // Slider fill
-                    Rectangle sliderFill = {sliderBg.x, sliderBg.y, sliderBg.width * musicVolume, sliderBg.height};
-                    DrawRectangleRec(sliderFill, SKYBLUE);
-
-                    // Slider handle
-                    float handleX = sliderBg.x + (sliderBg.width * musicVolume);
-                    DrawCircle(handleX, sliderBg.y + sliderBg.height/2, 12, WHITE);
-                    DrawCircleLines(handleX, sliderBg.y + sliderBg.height/2, 12, BLACK);
-
-                    // Volume percentage
-                    char volumeText[16];
-                    sprintf(volumeText, "%d%%", (int)(musicVolume * 100));
-                    DrawTextEx(setbackFont, volumeText, (Vector2){screenWidth/2 + 120, screenHeight/2 + 45}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
-
-                    // Instructions
-                    Vector2 closeSize2 = MeasureTextEx(setbackFont, GetText(STR_CLOSE_OPTIONS), TEXT_SIZE_MEDIUM, SETBACK_SPACING);
-                    DrawTextEx(setbackFont, GetText(STR_CLOSE_OPTIONS), (Vector2){screenWidth/2 - closeSize2.x/2, screenHeight/2 + 100}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, LIGHTGRAY);
-                }
-
-                // Draw game over message - using Mecha font
-                if (ammo < SHOT_COST) {
-                    Vector2 gameOverSize = MeasureTextEx(mechaFont, GetText(STR_OUT_OF_AMMO), SCORE_SIZE, MECHA_SPACING);
-                    DrawTextEx(mechaFont, GetText(STR_OUT_OF_AMMO), (Vector2){screenWidth/2 - gameOverSize.x/2, screenHeight/2}, SCORE_SIZE, MECHA_SPACING, RED);
+                    // Draw game over message - using Mecha font
+                    if (game.ammo < game.rules.shotCost) {
+                        Vector2 gameOverSize = MeasureTextEx(mechaFont, GetText(STR_OUT_OF_AMMO), SCORE_SIZE, MECHA_SPACING);
+                        DrawTextEx(mechaFont, GetText(STR_OUT_OF_AMMO), (Vector2){screenWidth/2 - gameOverSize.x/2, screenHeight/2}, SCORE_SIZE, MECHA_SPACING, RED);
+                    }
                 }
-            }
 
-        EndTextureMode();
+            CountPerfDrawCalls(&perfHud);
+            EndTextureMode();
+            drawnFrame = idleFrame;
+            drawnFrameValid = true;
+        }
+        TRACE_ZONE_END(drawZone);
+        MarkPerfPhase(&perfHud, PERF_PHASE_BLIT);
+        TRACE_ZONE_BEGIN(presentZone, "Present");
 
         // Now draw the scaled texture to the actual window
         BeginDrawing();
@@ -838,13 +903,41 @@ int main(void)
             Rectangle destRec = { finalCtx.offsetX, finalCtx.offsetY, finalCtx.drawWidth, finalCtx.drawHeight };
             DrawTexturePro(target.texture, sourceRec, destRec, (Vector2){0, 0}, 0.0f, WHITE);
 
+            // Drawn at window resolution so it stays readable
+            if (perfHud.visible) DrawPerfHud(&perfHud, &game);
+
+            if (timeWarp != 1 || !renderGame) {
+                int gameSeconds = (int)simulatedTime;
+                DrawText(TextFormat("Time warp %s  %d steps/frame  game time %02d:%02d:%02d  slowest step %.3f ms at %.0f s",
+                                    (timeWarp > 0) ? TextFormat("x%d", timeWarp) : "uncapped", frameSteps,
+                                    gameSeconds/3600, (gameSeconds/60)%60, gameSeconds%60, slowestStepMs, slowestStepTime),
+                         10, GetScreenHeight() - 30, 20, YELLOW);
+            }
+
+            CountPerfDrawCalls(&perfHud);
+            MarkPerfPhase(&perfHud, PERF_PHASE_PRESENT);
+
+        // EndDrawing() polls input, so this takes effect at the end of this frame
+        if (idle != wasIdle) {
+            if (idle) EnableEventWaiting();
+            else DisableEventWaiting();
+            wasIdle = idle;
+        }
         EndDrawing();
+        TRACE_ZONE_END(presentZone);
+        TRACE_ZONE_END(frameZone);
+        EndPerfFrame(&perfHud);
         //----------------------------------------------------------------------------------
     }
 
+    if (soakDuration > 0.0) PrintSoakReport(&soak);
+
     // De-Initialization
     //--------------------------------------------------------------------------------------
     CleanupLocalization();
+    UnloadDroneInstancing(&instancing);
+    UnloadUiLayer(&ui);
+    UnloadPerfHud(&perfHud);
     UnloadRenderTexture(target);
     // Unload TTF fonts (only unique font instances)
     UnloadFont(titleFont);
@@ -852,16 +945,12 @@ int main(void)
     UnloadFont(boldFont);
     UnloadFont(regularFont);
     UnloadFont(equationFont);
-    UnloadTexture(sahedTexture);
-    UnloadTexture(gepardTexture);
-    UnloadTexture(backgroundTexture);
-    UnloadTexture(flagGB);
-    UnloadTexture(flagPL);
-    UnloadTexture(flagUA);
+    SetShapesTexture((Texture2D){ 0 }, (Rectangle){ 0 });    // Back to raylib's own before the atlas goes
+    UnloadTexture(atlasTexture);
     UnloadSound(shootSound);
     UnloadSound(explosionSound);
-    CloseAudioDevice();
-    CloseWindow();
+    UnloadGameState(&game);
+    CloseSession(&replay, traceFile);
     //--------------------------------------------------------------------------------------
 
     return 0;
@@ -870,454 +959,15 @@ int main(void)
 //------------------------------------------------------------------------------------
 // Function Definitions
 //------------------------------------------------------------------------------------
-void DecomposeNumber(int num, int *tens, int *ones) {
-    if (num >= 0) {
-        *tens = (num / 10) * 10;
-        *ones = num % 10;
-    } else {
-        // For negative numbers, decompose the absolute value
-        int absNum = -num;
-        *tens = -((absNum / 10) * 10);
-        *ones = -(absNum % 10);
-    }
-}
-
-void CreateDecomposedEquation(MathEquation *eq) {
-    eq->partCount = 0;
-
-    int num1_tens, num1_ones;
-    int num2_tens, num2_ones;
-
-    DecomposeNumber(eq->num1, &num1_tens, &num1_ones);
-    DecomposeNumber(eq->num2, &num2_tens, &num2_ones);
-
-    switch(eq->operation) {
-        case '+': {
-            // For addition: highlight all tens in green
-            // Example: 18 + 23 = 10 + 8 + 10 + 10 + 3
-            int idx = 0;
-
-            // First number decomposition
-            if (num1_tens != 0) {
-                eq->parts[idx].value = num1_tens;
-                eq->parts[idx].operatorBefore = '\0';
-                eq->parts[idx].visualState = PART_HIGHLIGHT; // Green for tens
-                idx++;
-            }
-            if (num1_ones != 0) {
-                eq->parts[idx].value = num1_ones;
-                eq->parts[idx].operatorBefore = (num1_tens != 0) ? '+' : '\0';
-                eq->parts[idx].visualState = PART_NORMAL;
-                idx++;
-            }
-
-            // Second number decomposition
-            if (num2_tens != 0) {
-                eq->parts[idx].value = num2_tens;
-                eq->parts[idx].operatorBefore = '+';
-                eq->parts[idx].visualState = PART_HIGHLIGHT; // Green for tens
-                idx++;
-            }
-            if (num2_ones != 0) {
-                eq->parts[idx].value = num2_ones;
-                eq->parts[idx].operatorBefore = '+';
-                eq->parts[idx].visualState = PART_NORMAL;
-                idx++;
-            }
-
-            eq->partCount = idx;
-            break;
-        }
-
-        case '-': {
-            // For subtraction: implement pairing logic
-            // Example: 11 - 20 = 10 + 1 - 10 - 10
-            //                    (red)    (red)
-            int idx = 0;
-
-            // Build lists of positive and negative tens
-            int positiveTens[10] = {0};
-            int negativeTens[10] = {0};
-            int posTensCount = 0;
-            int negTensCount = 0;
-
-            // Add parts from num1 (all positive)
-            if (num1_tens != 0) {
-                int count = abs(num1_tens) / 10;
-                for (int i = 0; i < count; i++) {
-                    positiveTens[posTensCount++] = 10;
-                }
-            }
-
-            // Add parts from num2 (all negative in subtraction)
-            if (num2_tens != 0) {
-                int count = abs(num2_tens) / 10;
-                for (int i = 0; i < count; i++) {
-                    negativeTens[negTensCount++] = 10;
-                }
-            }
-
-            // Mark pairs for red highlighting (cancellation)
-            bool positiveCancelled[10] = {false};
-            bool negativeCancelled[10] = {false};
-
-            int pairsToMake = (posTensCount < negTensCount) ? posTensCount : negTensCount;
-            for (int i = 0; i < pairsToMake; i++) {
-                positiveCancelled[i] = true;
-                negativeCancelled[i] = true;
-            }
-
-            // Now build the parts array
-            // First number parts
-            if (num1_tens != 0) {
-                int count = abs(num1_tens) / 10;
-                for (int i = 0; i < count; i++) {
-                    eq->parts[idx].value = 10;
-                    eq->parts[idx].operatorBefore = (idx == 0) ? '\0' : '+';
-                    eq->parts[idx].visualState = positiveCancelled[i] ? PART_CANCELLED : PART_NORMAL;
-                    idx++;
-                }
-            }
-
-            if (num1_ones != 0) {
-                eq->parts[idx].value = num1_ones;
-                eq->parts[idx].operatorBefore = (idx == 0) ? '\0' : '+';
-                eq->parts[idx].visualState = PART_NORMAL;
-                idx++;
-            }
-
-            // Second number parts (subtracted)
-            if (num2_tens != 0) {
-                int count = abs(num2_tens) / 10;
-                for (int i = 0; i < count; i++) {
-                    eq->parts[idx].value = 10;
-                    eq->parts[idx].operatorBefore = '-';
-                    eq->parts[idx].visualState = negativeCancelled[i] ? PART_CANCELLED : PART_NORMAL;
-                    idx++;
-                }
-            }
-
-            if (num2_ones != 0) {
-                eq->parts[idx].value = abs(num2_ones);
-                eq->parts[idx].operatorBefore = '-';
-                eq->parts[idx].visualState = PART_NORMAL;
-                idx++;
-            }
-
-            eq->partCount = idx;
-            break;
-        }
-
-        case '*':
-        case '/':
-            // For multiplication and division, create a single "part" with the full equation
-            eq->parts[0].value = eq->num1;
-            eq->parts[0].operatorBefore = '\0';
-            eq->parts[0].visualState = PART_NORMAL;
-            eq->partCount = 1;
-            break;
-    }
-
-    // Also build the old string version for compatibility
-    char buffer[128] = "";
-    for (int i = 0; i < eq->partCount; i++) {
-        if (eq->parts[i].operatorBefore != '\0') {
-            sprintf(buffer + strlen(buffer), " %c ", eq->parts[i].operatorBefore);
-        }
-        sprintf(buffer + strlen(buffer), "%d", eq->parts[i].value);
-    }
-
-    if (eq->operation == '*') {
-        sprintf(buffer, "%d * %d", eq->num1, eq->num2);
-    } else if (eq->operation == '/') {
-        sprintf(buffer, "%d / %d", eq->num1, eq->num2);
-    }
-
-    sprintf(buffer + strlen(buffer), " = ?");
-    strcpy(eq->decomposed, buffer);
-}
-
-void GenerateNewEquation(MathEquation *eq, int level, Drone drones[], bool allowNegative) {
-    int opType;
-    int attempts = 0;
-    bool isTrivial;
-    bool duplicateAnswer;
-
-    do {
-        isTrivial = false;
-        duplicateAnswer = false;
-
-        // Determine available operations based on level
-        if (level == 1) {
-            opType = rand() % 2; // 0: add, 1: subtract
-        } else if (level == 2) {
-            opType = rand() % 3; // 0: add, 1: subtract, 2: multiply
-        } else {
-            opType = rand() % 4; // 0: add, 1: subtract, 2: multiply, 3: divide
-        }
-
-        switch(opType) {
-            case 0: // Addition
-                if (level == 1) {
-                    eq->num1 = 1 + rand() % 20; // 1-20 (avoid 0)
-                    eq->num2 = 1 + rand() % 20; // 1-20 (avoid 0)
-                } else {
-                    eq->num1 = 5 + rand() % 45;
-                    eq->num2 = 5 + rand() % 45;
-                }
-                eq->operation = '+';
-                eq->correctAnswer = eq->num1 + eq->num2;
-
-                // Check for trivial cases: 0+X or X+0
-                if (eq->num1 == 0 || eq->num2 == 0) {
-                    isTrivial = true;
-                }
-                break;
-
-            case 1: // Subtraction
-                if (allowNegative) {
-                    // Allow negative results
-                    if (level == 1) {
-                        eq->num1 = rand() % 21; // 0-20
-                        eq->num2 = rand() % 21; // 0-20
-                    } else {
-                        eq->num1 = rand() % 80; // 0-79
-                        eq->num2 = rand() % 80; // 0-79
-                    }
-                } else {
-                    // Only positive results
-                    if (level == 1) {
-                        eq->num1 = rand() % 21; // 0-20
-                        eq->num2 = rand() % (eq->num1 + 1); // Ensure result >= 0
-                    } else {
-                        eq->num1 = 20 + rand() % 60;
-                        eq->num2 = 5 + rand() % (eq->num1 - 4);
-                    }
-                }
-                eq->operation = '-';
-                eq->correctAnswer = eq->num1 - eq->num2;
-
-                // Check for trivial case: X-0
-                if (eq->num2 == 0) {
-                    isTrivial = true;
-                }
-                break;
-
-            case 2: // Multiplication
-                eq->num1 = 2 + rand() % 12;
-                eq->num2 = 2 + rand() % 12;
-                eq->operation = '*';
-                eq->correctAnswer = eq->num1 * eq->num2;
-                break;
-
-            case 3: // Division
-                // Generate answer first, then calculate dividend to ensure whole number result
-                eq->correctAnswer = 2 + rand() % 10; // Answer: 2-11
-                eq->num2 = 2 + rand() % 9; // Divisor: 2-10
-                eq->num1 = eq->correctAnswer * eq->num2; // Dividend
-                eq->operation = '/';
-                break;
-        }
-
-        // Check if the correct answer already exists on any active drone
-        for (int i = 0; i < MAX_DRONES; i++) {
-            if (drones[i].active && drones[i].state == DRONE_FLYING) {
-                if (drones[i].answer == eq->correctAnswer) {
-                    duplicateAnswer = true;
-                    break;
-                }
-            }
-        }
-
-        attempts++;
-        // Prevent infinite loop, after 20 attempts just accept what we have
-        if (attempts > 20) break;
-
-    } while (isTrivial || duplicateAnswer);
-
-    // Create decomposed version of the equation for children
-    CreateDecomposedEquation(eq);
+// Draw part of a sprite from the atlas, 'source' is relative to the sprite
+void DrawAtlasSprite(Texture2D atlas, AtlasSprite sprite, Rectangle source, Rectangle dest, Color tint) {
+    source.x += atlasRects[sprite].x;
+    source.y += atlasRects[sprite].y;
+    DrawTexturePro(atlas, source, dest, (Vector2){0, 0}, 0.0f, tint);
 }
 
-void SpawnDrones(Drone drones[], MathEquation *eq, int *activeDroneCount) {
-    int numDrones = DRONE_MIN_COUNT + rand() % (DRONE_MAX_COUNT - DRONE_MIN_COUNT + 1);
-    if (numDrones > MAX_DRONES) numDrones = MAX_DRONES;
-
-    // Check existing drones and mark any that match the new correct answer as Shahed
-    int existingAnswers[MAX_DRONES];
-    int existingCount = 0;
-    bool foundExistingShahed = false;
-    for (int i = 0; i < MAX_DRONES; i++) {
-        if (drones[i].active && drones[i].state == DRONE_FLYING) {
-            existingAnswers[existingCount++] = drones[i].answer;
-            // If this drone has the correct answer for the new equation, mark it as Shahed
-            if (drones[i].answer == eq->correctAnswer) {
-                drones[i].isShahed = true;
-                foundExistingShahed = true;
-            } else {
-                // Make sure old drones aren't marked as Shahed anymore
-                drones[i].isShahed = false;
-            }
-        }
-    }
-
-    // Generate answers, avoiding duplicates with existing drones
-    int answers[MAX_DRONES];
-    // If we found an existing drone with correct answer, don't spawn another one with same answer
-    int correctIndex = foundExistingShahed ? -1 : rand() % numDrones;
-
-    for (int i = 0; i < numDrones; i++) {
-        if (i == correctIndex) {
-            answers[i] = eq->correctAnswer;
-        } else {
-            // Generate wrong answer that doesn't duplicate existing or new answers
-            bool duplicate;
-            int attempts = 0;
-            do {
-                duplicate = false;
-                int offset = (rand() % 20) - 10;
-                if (offset == 0) offset = 5;
-                answers[i] = eq->correctAnswer + offset;
-
-                // Check against existing answers on screen
-                for (int j = 0; j < existingCount; j++) {
-                    if (answers[i] == existingAnswers[j]) {
-                        duplicate = true;
-                        break;
-                    }
-                }
-
-                // Check against already generated answers in this wave
-                if (!duplicate) {
-                    for (int j = 0; j < i; j++) {
-                        if (answers[i] == answers[j]) {
-                            duplicate = true;
-                            break;
-                        }
-                    }
-                }
-
-                attempts++;
-                if (attempts > 50) break; // Prevent infinite loop
-            } while (duplicate && attempts < 50);
-        }
-    }
-
-    // Find free slots and spawn drones
-    int spawned = 0;
-    for (int i = 0; i < MAX_DRONES && spawned < numDrones; i++) {
-        if (!drones[i].active || drones[i].state == DRONE_DEAD) {
-            drones[i].position.x = DRONE_SPAWN_X + spawned * DRONE_SPAWN_SPACING;
-            drones[i].position.y = DRONE_SPAWN_Y_MIN + rand() % (int)DRONE_SPAWN_Y_RANGE;
-            drones[i].answer = answers[spawned];
-            drones[i].isShahed = (spawned == correctIndex);
-            drones[i].state = DRONE_FLYING;
-            drones[i].animTimer = 0.0f;
-            drones[i].active = true;
-            spawned++;
-        }
-    }
-
-    *activeDroneCount = spawned;
-}
-
-void UpdateDrones(Drone drones[], float deltaTime) {
-    for (int i = 0; i < MAX_DRONES; i++) {
-        if (!drones[i].active) continue;
-
-        switch(drones[i].state) {
-            case DRONE_FLYING:
-                drones[i].position.x -= DRONE_SPEED * deltaTime;
-                // If Shahed reaches left side, make it fall down
-                if (drones[i].isShahed && drones[i].position.x < DRONE_LEFT_BOUNDARY) {
-                    drones[i].state = DRONE_FALLING;
-                    drones[i].animTimer = 0.0f;
-                }
-                // Non-Shahed drones just disappear off screen
-                else if (drones[i].position.x < OFF_SCREEN_LEFT) {
-                    drones[i].active = false;
-                }
-                break;
-
-            case DRONE_FAKE_DESTRUCTION:
-                // Play fake destruction animation for non-shahed drones (cells 2-4)
-                drones[i].animTimer += deltaTime;
-
-                // Make the drone fall during the animation
-                float animProgress = drones[i].animTimer / (FAKE_DESTRUCTION_FRAME_DURATION * 3.0f);
-                if (animProgress > 1.0f) animProgress = 1.0f;
-                drones[i].position.y = drones[i].stateStartY + (animProgress * FAKE_DESTRUCTION_FALL_DISTANCE);
-
-                // Continue moving left slightly
-                drones[i].position.x -= DRONE_SPEED * 0.3f * deltaTime;
-
-                // 3 frames * duration per frame
-                if (drones[i].animTimer > FAKE_DESTRUCTION_FRAME_DURATION * 3.0f) {
-                    drones[i].state = DRONE_DEAD;
-                }
-                break;
-
-            case DRONE_EXPLODING:
-                // Play real explosion animation (cells 6-10)
-                drones[i].animTimer += deltaTime;
-                // 5 frames * duration per frame
-                if (drones[i].animTimer > EXPLOSION_FRAME_DURATION * 5.0f) {
-                    drones[i].state = DRONE_DEAD;
-                }
-                break;
-
-            case DRONE_FALLING:
-                drones[i].animTimer += deltaTime;
-                drones[i].position.x -= DRONE_SPEED * DRONE_FALL_HORIZONTAL_MULTIPLIER * deltaTime;
-                drones[i].position.y += DRONE_FALL_SPEED * deltaTime;
-
-                // If Shahed hits ground, explode
-                if (drones[i].isShahed && drones[i].position.y >= GROUND_LEVEL) {
-                    drones[i].state = DRONE_EXPLODING;
-                    drones[i].animTimer = 0.0f;
-                    drones[i].position.y += GROUND_EXPLOSION_OFFSET;
-                }
-                // Non-Shahed drones just disappear when hitting ground or going off screen
-                else if (drones[i].position.y >= NEAR_GROUND_LEVEL || drones[i].position.x < OFF_SCREEN_LEFT) {
-                    drones[i].state = DRONE_DEAD;
-                }
-                break;
-
-            case DRONE_DEAD:
-                drones[i].active = false;
-                break;
-        }
-    }
-}
-
-void UpdateGepard(GepardTank *gepard, float deltaTime) {
-    if (gepard->isFiring) {
-        gepard->fireTimer += deltaTime;
-
-        if (gepard->fireTimer > FIRE_FRAME_DURATION) {
-            gepard->fireFrame++;
-            gepard->fireTimer = 0.0f;
-
-            if (gepard->fireFrame > 2) { // 0=normal, 1=middle, 2=top, then back to 0
-                gepard->fireFrame = 0;
-                gepard->isFiring = false;
-            }
-        }
-    }
-}
-
-int GetTurretIndexFromMouse(int mouseX, int screenWidth) {
-    // Map mouse X position to turret index (0-4)
-    // Right edge (screenWidth) -> index 0
-    // Left edge (0) -> index 4
-    float ratio = (float)mouseX / (float)screenWidth;
-    int index = (int)((1.0f - ratio) * 5);
-    if (index < 0) index = 0;
-    if (index > 4) index = 4;
-    return index;
-}
-
-void DrawDrone(Texture2D texture, Drone drone) {
+// Cell of the Shahed sheet a drone shows and where it goes, false when it is not drawn
+bool GetDroneSprite(Drone drone, Rectangle *source, Rectangle *dest) {
     Rectangle sourceRec;
 
     switch(drone.state) {
@@ -1354,14 +1004,14 @@ void DrawDrone(Texture2D texture, Drone drone) {
 
         case DRONE_DEAD:
             // Don't draw dead drones
-            return;
+            return false;
     }
 
     // Blink effect for falling drones near ground
     if (drone.state == DRONE_FALLING && drone.position.y >= NEAR_GROUND_LEVEL) {
         int blinkCycle = (int)(drone.animTimer * BLINK_FREQUENCY) % 2;
         if (blinkCycle == 0) {
-            return; // Don't draw (creates blink effect)
+            return false; // Don't draw (creates blink effect)
         }
     }
 
@@ -1382,11 +1032,17 @@ void DrawDrone(Texture2D texture, Drone drone) {
     }
 
     float drawSize = DRONE_TEXTURE_SIZE * scale;
-    Rectangle destRec = (Rectangle){ drone.position.x, drone.position.y, drawSize, drawSize };
-    DrawTexturePro(texture, sourceRec, destRec, (Vector2){0, 0}, 0.0f, WHITE);
+    *source = sourceRec;
+    *dest = (Rectangle){ drone.position.x, drone.position.y, drawSize, drawSize };
+    return true;
+}
+
+void DrawDrone(Texture2D atlas, Drone drone) {
+    Rectangle source, dest;
+    if (GetDroneSprite(drone, &source, &dest)) DrawAtlasSprite(atlas, ATLAS_SAHED, source, dest, WHITE);
 }
 
-void DrawGepard(Texture2D texture, GepardTank gepard, Vector2 position) {
+void DrawGepard(Texture2D atlas, GepardTank gepard, Vector2 position) {
     Rectangle sourceRec;
 
     // Determine which cell to draw
@@ -1401,7 +1057,7 @@ void DrawGepard(Texture2D texture, GepardTank gepard, Vector2 position) {
     // Scale tank using global GEPARD_SCALE constant
     float scaledSize = GEPARD_TEXTURE_SIZE * GEPARD_SCALE;
     Rectangle destRec = (Rectangle){ position.x, position.y, scaledSize, scaledSize };
-    DrawTexturePro(texture, sourceRec, destRec, (Vector2){0, 0}, 0.0f, WHITE);
+    DrawAtlasSprite(atlas, ATLAS_GEPARD, sourceRec, destRec, WHITE);
 }
 
 void DrawAmmo(int ammo, int screenWidth, int screenHeight) {
@@ -1418,99 +1074,23 @@ void DrawAmmo(int ammo, int screenWidth, int screenHeight) {
     }
 }
 
-void SpawnProjectile(Projectile projectiles[], Vector2 start, Vector2 target, int droneIndex) {
-    // Find free slot
-    for (int i = 0; i < MAX_PROJECTILES; i++) {
-        if (!projectiles[i].active) {
-            projectiles[i].position = start;
-            projectiles[i].active = true;
-            projectiles[i].lifetime = 0.0f;
-            projectiles[i].targetDroneIndex = droneIndex;
-
-            // Calculate velocity toward target
-            Vector2 direction = { target.x - start.x, target.y - start.y };
-            float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
-            if (length > 0) {
-                projectiles[i].velocity.x = (direction.x / length) * PROJECTILE_SPEED;
-                projectiles[i].velocity.y = (direction.y / length) * PROJECTILE_SPEED;
-            }
-            break;
-        }
-    }
-}
-
-void UpdateProjectiles(Projectile projectiles[], Drone drones[], int *ammo, int *score, bool *shahedActive, float deltaTime, Sound explosionSound) {
-    for (int i = 0; i < MAX_PROJECTILES; i++) {
-        if (projectiles[i].active) {
-            projectiles[i].position.x += projectiles[i].velocity.x * deltaTime;
-            projectiles[i].position.y += projectiles[i].velocity.y * deltaTime;
-            projectiles[i].lifetime += deltaTime;
-
-            // Check collision with target drone
-            int targetIdx = projectiles[i].targetDroneIndex;
-            if (targetIdx >= 0 && targetIdx < MAX_DRONES &&
-                drones[targetIdx].active &&
-                (drones[targetIdx].state == DRONE_FLYING || drones[targetIdx].state == DRONE_EXPLODING)) {
-
-                DroneBounds bounds = GetDroneBounds(drones[targetIdx]);
-
-                float dx = projectiles[i].position.x - bounds.center.x;
-                float dy = projectiles[i].position.y - bounds.center.y;
-                float distance = sqrtf(dx * dx + dy * dy);
-
-                // Hit detection using constant
-                if (distance < (bounds.width * PROJECTILE_HIT_RADIUS)) {
-                    projectiles[i].active = false;
-
-                    // Only apply damage effects if still flying (not already hit)
-                    if (drones[targetIdx].state == DRONE_FLYING) {
-                        if (drones[targetIdx].isShahed) {
-                            // Correct hit!
-                            drones[targetIdx].state = DRONE_EXPLODING;
-                            drones[targetIdx].animTimer = 0.0f;
-                            *ammo += HIT_REWARD;
-                            // Cap ammo at maximum
-                            if (*ammo > MAX_AMMO) {
-                                *ammo = MAX_AMMO;
-                            }
-                            *score += SCORE_CORRECT_HIT;
-                            *shahedActive = false; // Shahed destroyed, can generate new equation
-                        } else {
-                            // Wrong hit - show fake destruction animation
-                            drones[targetIdx].state = DRONE_FAKE_DESTRUCTION;
-                            drones[targetIdx].animTimer = 0.0f;
-                            drones[targetIdx].stateStartY = drones[targetIdx].position.y;
-                            *score += SCORE_WRONG_HIT; // Note: SCORE_WRONG_HIT is -5
-                        }
-                    }
-                }
-            }
-
-            // Deactivate if off-screen or lived too long
-            if (projectiles[i].position.x < OFF_SCREEN_TOP || projectiles[i].position.x > OFF_SCREEN_RIGHT ||
-                projectiles[i].position.y < OFF_SCREEN_TOP || projectiles[i].position.y > OFF_SCREEN_BOTTOM ||
-                projectiles[i].lifetime > PROJECTILE_MAX_LIFETIME) {
-                projectiles[i].active = false;
-            }
-        }
-    }
-}
-
-void DrawProjectiles(Projectile projectiles[]) {
-    for (int i = 0; i < MAX_PROJECTILES; i++) {
-        if (projectiles[i].active) {
-            // Draw as a bright yellow/orange tracer
-            Vector2 end = {
-                projectiles[i].position.x - projectiles[i].velocity.x * PROJECTILE_TRAIL_LENGTH,
-                projectiles[i].position.y - projectiles[i].velocity.y * PROJECTILE_TRAIL_LENGTH
-            };
-            DrawLineEx(projectiles[i].position, end, PROJECTILE_LINE_THICKNESS, YELLOW);
-            DrawCircleV(projectiles[i].position, PROJECTILE_DOT_RADIUS, ORANGE);
-        }
+void DrawProjectiles(const ProjectilePool *projectiles, float alpha) {
+    for (int i = 0; i < projectiles->count; i++) {
+        const Projectile *projectile = &projectiles->items[i];
+        Vector2 position = InterpolatePosition(projectile->prevPosition, projectile->position, alpha);
+
+        // Draw as a bright yellow/orange tracer
+        Vector2 end = {
+            position.x - projectile->velocity.x * PROJECTILE_TRAIL_LENGTH,
+            position.y - projectile->velocity.y * PROJECTILE_TRAIL_LENGTH
+        };
+        DrawLineEx(position, end, PROJECTILE_LINE_THICKNESS, YELLOW);
+        DrawCircleV(position, PROJECTILE_DOT_RADIUS, ORANGE);
     }
 }
 
 void DrawDecomposedEquation(MathEquation *eq, Font font, Vector2 position, float fontSize, float spacing, float blinkTimer) {
+    TRACE_ZONE_BEGIN(zone, "DrawDecomposedEquation");
     Vector2 currentPos = position;
 
     for (int i = 0; i < eq->partCount; i++) {
@@ -1555,6 +1135,423 @@ void DrawDecomposedEquation(MathEquation *eq, Font font, Vector2 position, float
     // Draw " = ?" at the end
     char endText[] = " = ?";
     DrawTextEx(font, endText, currentPos, fontSize, spacing, BLUE);
+    TRACE_ZONE_END(zone);
+}
+
+//------------------------------------------------------------------------------------
+// Answer Labels
+//------------------------------------------------------------------------------------
+static unsigned int HashAnswerLabel(unsigned int fontId, float fontSize, float spacing, int answer) {
+    unsigned int hash = 2166136261u;
+    hash = (hash ^ fontId) * 16777619u;
+    hash = (hash ^ (unsigned int)(fontSize * 64.0f)) * 16777619u;
+    hash = (hash ^ (unsigned int)(spacing * 64.0f)) * 16777619u;
+    hash = (hash ^ (unsigned int)answer) * 16777619u;
+    return hash ^ (hash >> 15);
+}
+
+// Same layout DrawTextEx() does, done once: find each glyph and advance the pen
+static void LayoutAnswerLabel(AnswerLabel *label, Font font) {
+    char text[LABEL_MAX_GLYPHS + 1];
+    snprintf(text, sizeof(text), "%d", label->answer);
+    label->size = MeasureTextEx(font, text, label->fontSize, label->spacing);
+
+    float scaleFactor = label->fontSize / font.baseSize;
+    float penX = 0.0f;
+    label->glyphCount = 0;
+    for (const char *c = text; *c != '\0'; c++) {
+        int index = GetGlyphIndex(font, *c);
+        label->glyphIndex[label->glyphCount] = index;
+        label->glyphX[label->glyphCount] = penX;
+        label->glyphCount++;
+
+        float advance = (font.glyphs[index].advanceX != 0) ? (float)font.glyphs[index].advanceX : font.recs[index].width;
+        penX += advance * scaleFactor + label->spacing;
+    }
+}
+
+// Cached label for an answer, laid out on first use and only good until the next call.
+// The cache starts over once half full, by then most labels belong to drones long gone.
+const AnswerLabel *GetAnswerLabel(LabelCache *cache, Font font, int answer, float fontSize, float spacing) {
+    unsigned int fontId = font.texture.id;
+    unsigned int slot = HashAnswerLabel(fontId, fontSize, spacing, answer) & (LABEL_CACHE_SLOTS - 1);
+    while (cache->labels[slot].used) {
+        AnswerLabel *label = &cache->labels[slot];
+        if (label->answer == answer && label->fontId == fontId && label->fontSize == fontSize && label->spacing == spacing) return label;
+        slot = (slot + 1) & (LABEL_CACHE_SLOTS - 1);
+    }
+
+    if (cache->count >= LABEL_CACHE_SLOTS/2) {
+        memset(cache, 0, sizeof(*cache));
+        slot = HashAnswerLabel(fontId, fontSize, spacing, answer) & (LABEL_CACHE_SLOTS - 1);
+    }
+
+    AnswerLabel *label = &cache->labels[slot];
+    label->used = true;
+    label->fontId = fontId;
+    label->fontSize = fontSize;
+    label->spacing = spacing;
+    label->answer = answer;
+    LayoutAnswerLabel(label, font);
+    cache->count++;
+    return label;
+}
+
+// Draw the glyphs of a laid out label, as DrawTextCodepoint() would draw them
+void DrawAnswerLabel(Font font, const AnswerLabel *label, Vector2 position, Color tint) {
+    float scaleFactor = label->fontSize / font.baseSize;
+    float padding = (float)font.glyphPadding;
+    for (int i = 0; i < label->glyphCount; i++) {
+        int index = label->glyphIndex[i];
+        Rectangle rec = font.recs[index];
+        Rectangle source = { rec.x - padding, rec.y - padding, rec.width + 2.0f*padding, rec.height + 2.0f*padding };
+        Rectangle dest = {
+            position.x + label->glyphX[i] + (font.glyphs[index].offsetX - padding)*scaleFactor,
+            position.y + (font.glyphs[index].offsetY - padding)*scaleFactor,
+            source.width*scaleFactor,
+            source.height*scaleFactor
+        };
+        DrawTexturePro(font.texture, source, dest, (Vector2){ 0, 0 }, 0.0f, tint);
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Instanced Drone Drawing
+//------------------------------------------------------------------------------------
+// Each vertex is a corner of the unit quad, stretched over the instance's rectangles
+static const char *droneVertexShader =
+    "in vec2 vertexCorner;\n"
+    "in vec4 instanceDest;\n"           // x, y, width, height in virtual screen pixels
+    "in vec4 instanceSource;\n"         // u, v, width, height in atlas UV space
+    "uniform mat4 projection;\n"
+    "uniform mat4 modelview;\n"
+    "out vec2 fragTexCoord;\n"
+    "void main() {\n"
+    "    fragTexCoord = instanceSource.xy + vertexCorner*instanceSource.zw;\n"
+    "    gl_Position = projection*modelview*vec4(instanceDest.xy + vertexCorner*instanceDest.zw, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *droneFragmentShader =
+    "in vec2 fragTexCoord;\n"
+    "uniform sampler2D droneAtlas;\n"    // Not texture0, so raylib's default fragment stage can be told apart
+    "out vec4 finalColor;\n"
+    "void main() {\n"
+    "    finalColor = texture(droneAtlas, fragTexCoord);\n"
+    "}\n";
+
+void InitDroneInstancing(DroneInstancing *instancing) {
+    memset(instancing, 0, sizeof(*instancing));
+    instancing->enabled = true;
+
+    // ES vertex stages are highp by default; the fragment stage needs it too, mediump UVs
+    // land a texel off across the 2048 wide atlas
+    const char *header;
+    const char *fragmentHeader;
+    switch (rlGetVersion()) {
+        case RL_OPENGL_33:
+        case RL_OPENGL_43: header = fragmentHeader = "#version 330\n"; break;
+        case RL_OPENGL_ES_30:
+            header = "#version 300 es\n";
+            fragmentHeader = "#version 300 es\nprecision highp float;\n";
+            break;
+        default:
+            printf("Instanced drawing needs OpenGL 3.3 or ES 3.0, drawing drones one by one\n");
+            return;
+    }
+
+    char vertexCode[1024];
+    char fragmentCode[512];
+    snprintf(vertexCode, sizeof(vertexCode), "%s%s", header, droneVertexShader);
+    snprintf(fragmentCode, sizeof(fragmentCode), "%s%s", fragmentHeader, droneFragmentShader);
+
+    // raylib hands back its default shader when linking fails, and swaps in its default
+    // stage for one that does not compile: only our own names prove both stages are ours
+    Shader shader = LoadShaderFromMemory(vertexCode, fragmentCode);
+    int cornerLoc = GetShaderLocationAttrib(shader, "vertexCorner");
+    int destLoc = GetShaderLocationAttrib(shader, "instanceDest");
+    int sourceLoc = GetShaderLocationAttrib(shader, "instanceSource");
+    int atlasLoc = GetShaderLocation(shader, "droneAtlas");
+    if (shader.id == rlGetShaderIdDefault() || cornerLoc < 0 || destLoc < 0 || sourceLoc < 0 || atlasLoc < 0) {
+        printf("Could not build the instanced drone shader, drawing drones one by one\n");
+        if (shader.id != rlGetShaderIdDefault()) UnloadShader(shader);
+        return;
+    }
+
+    instancing->vao = rlLoadVertexArray();
+    if (instancing->vao == 0) {
+        UnloadShader(shader);
+        return;
+    }
+
+    // Two triangles of the unit quad, shared by every instance
+    static const float corners[12] = { 0, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 0 };
+    rlEnableVertexArray(instancing->vao);
+    instancing->cornerBuffer = rlLoadVertexBuffer(corners, sizeof(corners), false);
+    rlSetVertexAttribute(cornerLoc, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(cornerLoc);
+
+    // Per-instance rectangles, advancing once per drone
+    instancing->destBuffer = rlLoadVertexBuffer(NULL, sizeof(instancing->dest), true);
+    rlSetVertexAttribute(destLoc, 4, RL_FLOAT, false, 0, 0);
+    rlSetVertexAttributeDivisor(destLoc, 1);
+    rlEnableVertexAttribute(destLoc);
+    instancing->sourceBuffer = rlLoadVertexBuffer(NULL, sizeof(instancing->source), true);
+    rlSetVertexAttribute(sourceLoc, 4, RL_FLOAT, false, 0, 0);
+    rlSetVertexAttributeDivisor(sourceLoc, 1);
+    rlEnableVertexAttribute(sourceLoc);
+    rlDisableVertexArray();
+
+    instancing->shader = shader;
+    instancing->projectionLoc = GetShaderLocation(shader, "projection");
+    instancing->modelviewLoc = GetShaderLocation(shader, "modelview");
+    instancing->supported = true;
+}
+
+void UnloadDroneInstancing(DroneInstancing *instancing) {
+    if (!instancing->supported) return;
+    rlUnloadVertexArray(instancing->vao);
+    rlUnloadVertexBuffer(instancing->cornerBuffer);
+    rlUnloadVertexBuffer(instancing->destBuffer);
+    rlUnloadVertexBuffer(instancing->sourceBuffer);
+    UnloadShader(instancing->shader);
+    instancing->supported = false;
+}
+
+bool IsDroneInstancingUsed(const DroneInstancing *instancing, int droneCount) {
+    return instancing->supported && instancing->enabled && droneCount >= DRONE_INSTANCING_MIN;
+}
+
+// Draw every drone with one call, returns how many were drawn. Whatever is waiting in
+// the batch is drawn first, so the drones keep their place in the drawing order.
+int DrawDroneInstances(DroneInstancing *instancing, Texture2D atlas, const DronePool *drones, float alpha) {
+    Rectangle sheet = atlasRects[ATLAS_SAHED];
+    int count = 0;
+    for (int i = 0; i < drones->count; i++) {
+        Drone drone = GetDrone(drones, i);
+        drone.position = InterpolatePosition(drone.prevPosition, drone.position, alpha);
+
+        Rectangle source, dest;
+        if (!GetDroneSprite(drone, &source, &dest)) continue;
+
+        instancing->dest[count] = dest;
+        instancing->source[count] = (Rectangle){ (sheet.x + source.x) / atlas.width, (sheet.y + source.y) / atlas.height,
+                                                 source.width / atlas.width, source.height / atlas.height };
+        count++;
+    }
+
+    rlDrawRenderBatchActive();
+    if (count == 0) return 0;
+
+    rlEnableShader(instancing->shader.id);
+    rlSetUniformMatrix(instancing->projectionLoc, rlGetMatrixProjection());
+    rlSetUniformMatrix(instancing->modelviewLoc, rlGetMatrixModelview());
+    rlActiveTextureSlot(0);
+    rlEnableTexture(atlas.id);
+
+    rlEnableVertexArray(instancing->vao);
+    rlUpdateVertexBuffer(instancing->destBuffer, instancing->dest, count*sizeof(Rectangle), 0);
+    rlUpdateVertexBuffer(instancing->sourceBuffer, instancing->source, count*sizeof(Rectangle), 0);
+    rlDrawVertexArrayInstanced(0, 6, count);
+    rlDisableVertexArray();
+
+    rlDisableTexture();
+    rlDisableShader();
+
+    return count;
+}
+
+//------------------------------------------------------------------------------------
+// Retained Menus
+//------------------------------------------------------------------------------------
+static void DrawLevelSelectScreen(const UiLayer *ui, UiState state) {
+    const int screenWidth = ui->width;
+    const int screenHeight = ui->height;
+
+    ClearBackground((Color){135, 206, 235, 255}); // Sky blue for menu
+
+    // Measure and center title
+    Vector2 titleSize = MeasureTextEx(ui->textFont, GetText(STR_GAME_TITLE), TITLE_SIZE_LARGE, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_GAME_TITLE), (Vector2){screenWidth/2 - titleSize.x/2, screenHeight/2 - 120}, TITLE_SIZE_LARGE, SETBACK_SPACING, BLACK);
+
+    Vector2 subtitleSize = MeasureTextEx(ui->textFont, GetText(STR_GAME_SUBTITLE), TITLE_SIZE_MEDIUM, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_GAME_SUBTITLE), (Vector2){screenWidth/2 - subtitleSize.x/2, screenHeight/2 - 60}, TITLE_SIZE_MEDIUM, SETBACK_SPACING, DARKGRAY);
+
+    Vector2 instructionsSize = MeasureTextEx(ui->textFont, GetText(STR_GAME_INSTRUCTIONS), TEXT_SIZE_LARGE, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_GAME_INSTRUCTIONS), (Vector2){screenWidth/2 - instructionsSize.x/2, screenHeight/2 - 30}, TEXT_SIZE_LARGE, SETBACK_SPACING, DARKGRAY);
+
+    Vector2 selectLevelSize = MeasureTextEx(ui->textFont, GetText(STR_SELECT_LEVEL), TEXT_SIZE_LARGE, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_SELECT_LEVEL), (Vector2){screenWidth/2 - selectLevelSize.x/2, screenHeight/2 + 20}, TEXT_SIZE_LARGE, SETBACK_SPACING, BLACK);
+
+    Vector2 level1Size = MeasureTextEx(ui->textFont, GetText(STR_LEVEL_1_DESC), TEXT_SIZE_LARGE, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_LEVEL_1_DESC), (Vector2){screenWidth/2 - level1Size.x/2, screenHeight/2 + 60}, TEXT_SIZE_LARGE, SETBACK_SPACING, DARKGREEN);
+
+    Vector2 level2Size = MeasureTextEx(ui->textFont, GetText(STR_LEVEL_2_DESC), TEXT_SIZE_LARGE, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_LEVEL_2_DESC), (Vector2){screenWidth/2 - level2Size.x/2, screenHeight/2 + 90}, TEXT_SIZE_LARGE, SETBACK_SPACING, ORANGE);
+
+    Vector2 level3Size = MeasureTextEx(ui->textFont, GetText(STR_LEVEL_3_DESC), TEXT_SIZE_LARGE, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_LEVEL_3_DESC), (Vector2){screenWidth/2 - level3Size.x/2, screenHeight/2 + 120}, TEXT_SIZE_LARGE, SETBACK_SPACING, RED);
+
+    // Options hint
+    Vector2 optionsSize = MeasureTextEx(ui->textFont, GetText(STR_PRESS_OPTIONS), TEXT_SIZE_MEDIUM, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_PRESS_OPTIONS), (Vector2){screenWidth/2 - optionsSize.x/2, screenHeight/2 + 160}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, BLUE);
+
+    // Draw language selection flags at the bottom
+    const float flagSize = 60.0f;
+    const float flagSpacing = 20.0f;
+    const float flagY = screenHeight - 100.0f;
+
+    // English flag (GB)
+    Rectangle flagDestGB = {screenWidth/2 - flagSize - flagSpacing - flagSize/2, flagY, flagSize, flagSize * 0.6f};
+    DrawAtlasSprite(ui->atlas, ATLAS_FLAG_GB, (Rectangle){0, 0, atlasRects[ATLAS_FLAG_GB].width, atlasRects[ATLAS_FLAG_GB].height}, flagDestGB, WHITE);
+    if (state.language == LANG_ENGLISH) {
+        DrawRectangleLinesEx(flagDestGB, 3, GREEN);
+    } else {
+        DrawRectangleLinesEx(flagDestGB, 2, BLACK);
+    }
+
+    // Polish flag (PL)
+    Rectangle flagDestPL = {screenWidth/2 - flagSize/2, flagY, flagSize, flagSize * 0.6f};
+    DrawAtlasSprite(ui->atlas, ATLAS_FLAG_PL, (Rectangle){0, 0, atlasRects[ATLAS_FLAG_PL].width, atlasRects[ATLAS_FLAG_PL].height}, flagDestPL, WHITE);
+    if (state.language == LANG_POLISH) {
+        DrawRectangleLinesEx(flagDestPL, 3, GREEN);
+    } else {
+        DrawRectangleLinesEx(flagDestPL, 2, BLACK);
+    }
+
+    // Ukrainian flag (UA)
+    Rectangle flagDestUA = {screenWidth/2 + flagSpacing + flagSize/2, flagY, flagSize, flagSize * 0.6f};
+    DrawAtlasSprite(ui->atlas, ATLAS_FLAG_UA, (Rectangle){0, 0, atlasRects[ATLAS_FLAG_UA].width, atlasRects[ATLAS_FLAG_UA].height}, flagDestUA, WHITE);
+    if (state.language == LANG_UKRAINIAN) {
+        DrawRectangleLinesEx(flagDestUA, 3, GREEN);
+    } else {
+        DrawRectangleLinesEx(flagDestUA, 2, BLACK);
+    }
+}
+
+static void DrawOptionsScreen(const UiLayer *ui, UiState state) {
+    const int screenWidth = ui->width;
+    const int screenHeight = ui->height;
+
+    // Dark overlay
+    DrawRectangle(0, 0, screenWidth, screenHeight, (Color){0, 0, 0, 180});
+
+    // Menu title
+    Vector2 optionsTitleSize = MeasureTextEx(ui->titleFont, GetText(STR_OPTIONS), TITLE_SIZE_LARGE, MECHA_SPACING);
+    DrawTextEx(ui->titleFont, GetText(STR_OPTIONS), (Vector2){screenWidth/2 - optionsTitleSize.x/2, screenHeight/2 - 150}, TITLE_SIZE_LARGE, MECHA_SPACING, WHITE);
+
+    // Option 1: Show Equation Breakdown
+    DrawTextEx(ui->textFont, GetText(STR_SHOW_BREAKDOWN), (Vector2){screenWidth/2 - 200, screenHeight/2 - 70}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
+
+    // Checkbox 1
+    Rectangle checkboxRect1 = {screenWidth/2 + 180, screenHeight/2 - 80, 30, 30};
+    DrawRectangleRec(checkboxRect1, WHITE);
+    DrawRectangleLinesEx(checkboxRect1, 2, BLACK);
+    if (state.showEquationBreakdown) {
+        // Draw checkmark
+        DrawRectangle(checkboxRect1.x + 5, checkboxRect1.y + 5, 20, 20, GREEN);
+    }
+
+    // Option 2: Allow Negative Results
+    DrawTextEx(ui->textFont, GetText(STR_ALLOW_NEGATIVE), (Vector2){screenWidth/2 - 200, screenHeight/2 - 20}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
+
+    // Checkbox 2
+    Rectangle checkboxRect2 = {screenWidth/2 + 180, screenHeight/2 - 30, 30, 30};
+    DrawRectangleRec(checkboxRect2, WHITE);
+    DrawRectangleLinesEx(checkboxRect2, 2, BLACK);
+    if (state.allowNegativeResults) {
+        // Draw checkmark
+        DrawRectangle(checkboxRect2.x + 5, checkboxRect2.y + 5, 20, 20, GREEN);
+    }
+
+    // Option 3: Music Volume
+    DrawTextEx(ui->textFont, GetText(STR_MUSIC_VOLUME), (Vector2){screenWidth/2 - 200, screenHeight/2 + 40}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
+
+    // Slider
+    Rectangle sliderBg = {screenWidth/2 - 100, screenHeight/2 + 50, 200, 20};
+    DrawRectangleRec(sliderBg, DARKGRAY);
+    DrawRectangleLinesEx(sliderBg, 2, WHITE);
+
+    // Slider fill
+    Rectangle sliderFill = {sliderBg.x, sliderBg.y, sliderBg.width * state.musicVolume, sliderBg.height};
+    DrawRectangleRec(sliderFill, SKYBLUE);
+
+    // Slider handle
+    float handleX = sliderBg.x + (sliderBg.width * state.musicVolume);
+    DrawCircle(handleX, sliderBg.y + sliderBg.height/2, 12, WHITE);
+    DrawCircleLines(handleX, sliderBg.y + sliderBg.height/2, 12, BLACK);
+
+    // Volume percentage
+    char volumeText[16];
+    sprintf(volumeText, "%d%%", (int)(state.musicVolume * 100));
+    DrawTextEx(ui->textFont, volumeText, (Vector2){screenWidth/2 + 120, screenHeight/2 + 45}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, WHITE);
+
+    // Instructions
+    Vector2 closeSize = MeasureTextEx(ui->textFont, GetText(STR_CLOSE_OPTIONS), TEXT_SIZE_MEDIUM, SETBACK_SPACING);
+    DrawTextEx(ui->textFont, GetText(STR_CLOSE_OPTIONS), (Vector2){screenWidth/2 - closeSize.x/2, screenHeight/2 + 100}, TEXT_SIZE_MEDIUM, SETBACK_SPACING, LIGHTGRAY);
+}
+
+static void DrawPauseScreen(const UiLayer *ui) {
+    const int screenWidth = ui->width;
+    const int screenHeight = ui->height;
+
+    DrawRectangle(0, 0, screenWidth, screenHeight, (Color){0, 0, 0, 128});
+    Vector2 pausedSize = MeasureTextEx(ui->titleFont, GetText(STR_PAUSED), TITLE_SIZE_LARGE, MECHA_SPACING);
+    DrawTextEx(ui->titleFont, GetText(STR_PAUSED), (Vector2){screenWidth/2 - pausedSize.x/2, screenHeight/2 - 40}, TITLE_SIZE_LARGE, MECHA_SPACING, WHITE);
+    Vector2 resumeSize = MeasureTextEx(ui->titleFont, GetText(STR_PRESS_RESUME), SCORE_SIZE, MECHA_SPACING);
+    DrawTextEx(ui->titleFont, GetText(STR_PRESS_RESUME), (Vector2){screenWidth/2 - resumeSize.x/2, screenHeight/2 + 20}, SCORE_SIZE, MECHA_SPACING, WHITE);
+}
+
+void InitUiLayer(UiLayer *ui, int width, int height, Font titleFont, Font textFont, Texture2D atlas) {
+    memset(ui, 0, sizeof(*ui));
+    ui->width = width;
+    ui->height = height;
+    ui->titleFont = titleFont;
+    ui->textFont = textFont;
+    ui->atlas = atlas;
+    for (int i = 0; i < UI_SCREEN_COUNT; i++) ui->screens[i] = LoadRenderTexture(width, height);
+}
+
+void UnloadUiLayer(UiLayer *ui) {
+    for (int i = 0; i < UI_SCREEN_COUNT; i++) UnloadRenderTexture(ui->screens[i]);
+    memset(ui, 0, sizeof(*ui));
+}
+
+static bool IsSameUiState(UiState a, UiState b) {
+    return (a.language == b.language) && (a.showEquationBreakdown == b.showEquationBreakdown) &&
+           (a.allowNegativeResults == b.allowNegativeResults) && (a.musicVolume == b.musicVolume);
+}
+
+// Re-render a screen if it was last drawn with a different state. Render textures don't
+// nest, so call it before BeginTextureMode() of the frame.
+void UpdateUiScreen(UiLayer *ui, UiScreen screen, UiState state) {
+    if (ui->valid[screen] && IsSameUiState(ui->drawnState[screen], state)) return;
+
+    BeginTextureMode(ui->screens[screen]);
+        ClearBackground(BLANK);
+
+        // Alpha is accumulated as coverage, leaving the texture premultiplied so the
+        // overlays blend over the game exactly as if they were drawn straight onto it
+        rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+        BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+            switch (screen) {
+                case UI_SCREEN_LEVEL_SELECT: DrawLevelSelectScreen(ui, state); break;
+                case UI_SCREEN_OPTIONS: DrawOptionsScreen(ui, state); break;
+                case UI_SCREEN_PAUSE: DrawPauseScreen(ui); break;
+                default: break;
+            }
+        EndBlendMode();
+    EndTextureMode();
+
+    ui->valid[screen] = true;
+    ui->drawnState[screen] = state;
+}
+
+// Draw a screen rendered by UpdateUiScreen() over the whole virtual screen
+void DrawUiScreen(const UiLayer *ui, UiScreen screen) {
+    Texture2D texture = ui->screens[screen].texture;
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+        DrawTextureRec(texture, (Rectangle){ 0, 0, (float)texture.width, -(float)texture.height }, (Vector2){ 0, 0 }, WHITE);
+    EndBlendMode();
 }
 
 //------------------------------------------------------------------------------------
@@ -1584,34 +1581,132 @@ RenderContext CalculateRenderContext(int screenWidth, int screenHeight) {
     return ctx;
 }
 
-DroneBounds GetDroneBounds(Drone drone) {
-    DroneBounds bounds;
-    bounds.width = DRONE_TEXTURE_SIZE * DRONE_SCALE;
-    bounds.height = DRONE_TEXTURE_SIZE * DRONE_SCALE;
-    bounds.center.x = drone.position.x + bounds.width / 2.0f;
-    bounds.center.y = drone.position.y + bounds.height / 2.0f;
-    bounds.bounds = (Rectangle){ drone.position.x, drone.position.y, bounds.width, bounds.height };
-    return bounds;
+// Teardown shared by the windowed and the headless exit: finish the trace and replay
+// files, then close whatever of the audio device and window did open
+void CloseSession(ReplayFile *replay, const char *traceFile) {
+    if (IsTraceCapturing()) {
+        if (EndTraceCapture(traceFile)) printf("Trace written to %s\n", traceFile);
+        else printf("Could not write trace file %s\n", traceFile);
+    }
+    CloseReplay(replay);
+    if (IsAudioDeviceReady()) CloseAudioDevice();
+    if (IsWindowReady()) CloseWindow();
 }
 
-DroneStatus CheckDroneStatus(Drone drones[]) {
-    DroneStatus status = {false, false, 0};
-    for (int i = 0; i < MAX_DRONES; i++) {
-        if (drones[i].active && drones[i].state != DRONE_DEAD) {
-            status.aliveCount++;
-            if (drones[i].isShahed && drones[i].state == DRONE_FLYING) {
-                status.shahedFound = true;
-                status.canWin = true;
-            }
+bool IsSameIdleFrame(IdleFrame a, IdleFrame b) {
+    return (a.levelSelected == b.levelSelected) && (a.showOptionsMenu == b.showOptionsMenu) &&
+           (a.paused == b.paused) && (a.gameStarted == b.gameStarted) && (a.renderGame == b.renderGame) &&
+           IsSameUiState(a.ui, b.ui);
+}
+
+//------------------------------------------------------------------------------------
+// Performance HUD
+//------------------------------------------------------------------------------------
+void InitPerfHud(PerfHud *hud) {
+    memset(hud, 0, sizeof(*hud));
+}
+
+void UnloadPerfHud(PerfHud *hud) {
+    SetPerfHudVisible(hud, false);
+    if (hud->batchLoaded) rlUnloadRenderBatch(hud->batch);
+    hud->batchLoaded = false;
+}
+
+// Show or hide the HUD. Its own batch is only active while it is shown, so hidden it
+// leaves rlgl's default batch alone. Switching batches flushes the one in use.
+void SetPerfHudVisible(PerfHud *hud, bool visible) {
+    if (visible == hud->visible) return;
+
+    if (visible) {
+        if (!hud->batchLoaded) {
+            hud->batch = rlLoadRenderBatch(RL_DEFAULT_BATCH_BUFFERS, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+            hud->batchLoaded = true;
         }
+        rlSetRenderBatchActive(&hud->batch);
+    } else {
+        rlSetRenderBatchActive(NULL);   // Back to the default batch
     }
-    return status;
+
+    hud->visible = visible;
 }
 
-Vector2 GetBarrelPosition(Vector2 gepardPos, bool isLeftBarrel) {
-    float barrelX = isLeftBarrel ? GEPARD_BARREL_LEFT_X : GEPARD_BARREL_RIGHT_X;
-    return (Vector2){
-        gepardPos.x + (GEPARD_TEXTURE_SIZE * GEPARD_SCALE * barrelX),
-        gepardPos.y + (GEPARD_TEXTURE_SIZE * GEPARD_SCALE * GEPARD_BARREL_Y)
-    };
+void BeginPerfFrame(PerfHud *hud) {
+    for (int i = 0; i < PERF_PHASE_COUNT; i++) hud->phaseMs[hud->head][i] = 0.0f;
+    hud->phase = PERF_PHASE_INPUT;
+    hud->phaseStart = GetClockNanoseconds();
+}
+
+// Close the running phase and start timing the next one
+void MarkPerfPhase(PerfHud *hud, PerfPhase next) {
+    uint64_t now = GetClockNanoseconds();
+    hud->phaseMs[hud->head][hud->phase] += (float)(now - hud->phaseStart) / 1000000.0f;
+    hud->phase = next;
+    hud->phaseStart = now;
+}
+
+// Add the draw calls waiting in the batch, call right before a flush (EndTextureMode,
+// EndDrawing). Draws flushed early because the batch filled up are not seen.
+void CountPerfDrawCalls(PerfHud *hud) {
+    if (!hud->visible) return;
+    for (int i = 0; i < hud->batch.drawCounter; i++) {
+        if (hud->batch.draws[i].vertexCount > 0) hud->drawCalls++;
+    }
+}
+
+void EndPerfFrame(PerfHud *hud) {
+    MarkPerfPhase(hud, PERF_PHASE_INPUT);
+    hud->lastDrawCalls = hud->drawCalls;
+    hud->drawCalls = 0;
+    hud->head = (hud->head + 1) % PERF_HISTORY_FRAMES;
+    if (hud->frameCount < PERF_HISTORY_FRAMES) hud->frameCount++;
+}
+
+// Stacked per-phase frame time graph with averages and entity counts
+void DrawPerfHud(const PerfHud *hud, const GameState *game) {
+    const char *phaseNames[PERF_PHASE_COUNT] = { "input", "update", "render", "blit", "present" };
+    const Color phaseColors[PERF_PHASE_COUNT] = { SKYBLUE, LIME, ORANGE, VIOLET, GRAY };
+    const int x = 10;
+    const int y = 10;
+    const int graphHeight = (int)(PERF_GRAPH_MAX_MS * PERF_GRAPH_MS_HEIGHT);
+    const int panelWidth = PERF_HISTORY_FRAMES * 2 + 20;
+    const int textY = y + graphHeight + 15;
+
+    DrawRectangle(x, y, panelWidth, graphHeight + 120, Fade(BLACK, 0.75f));
+
+    // Oldest frame on the left, bars stacked in phase order
+    float averageMs[PERF_PHASE_COUNT] = { 0 };
+    for (int i = 0; i < hud->frameCount; i++) {
+        int slot = (hud->head - hud->frameCount + i + PERF_HISTORY_FRAMES) % PERF_HISTORY_FRAMES;
+        float barBottom = (float)(y + 10 + graphHeight);
+        for (int phase = 0; phase < PERF_PHASE_COUNT; phase++) {
+            float ms = hud->phaseMs[slot][phase];
+            averageMs[phase] += ms / hud->frameCount;
+
+            float height = ms * PERF_GRAPH_MS_HEIGHT;
+            if (barBottom - height < y + 10) height = barBottom - (y + 10);
+            if (height <= 0.0f) continue;
+            DrawRectangle(x + 10 + i * 2, (int)(barBottom - height), 2, (int)ceilf(height), phaseColors[phase]);
+            barBottom -= height;
+        }
+    }
+
+    // 60 and 30 FPS budgets
+    int line60 = y + 10 + graphHeight - (int)(1000.0f / 60.0f * PERF_GRAPH_MS_HEIGHT);
+    int line30 = y + 10 + graphHeight - (int)(1000.0f / 30.0f * PERF_GRAPH_MS_HEIGHT);
+    DrawLine(x + 10, line60, x + 10 + PERF_HISTORY_FRAMES * 2, line60, Fade(GREEN, 0.6f));
+    DrawLine(x + 10, line30, x + 10 + PERF_HISTORY_FRAMES * 2, line30, Fade(RED, 0.6f));
+
+    float totalMs = 0.0f;
+    for (int phase = 0; phase < PERF_PHASE_COUNT; phase++) {
+        totalMs += averageMs[phase];
+        DrawRectangle(x + 10, textY + phase * 14 + 2, 8, 8, phaseColors[phase]);
+        DrawText(TextFormat("%-8s %6.2f ms", phaseNames[phase], averageMs[phase]), x + 22, textY + phase * 14, 10, RAYWHITE);
+    }
+
+    int infoX = x + 140;
+    DrawText(TextFormat("frame %.2f ms", totalMs), infoX, textY, 10, RAYWHITE);
+    DrawText(TextFormat("%d FPS", GetFPS()), infoX, textY + 14, 10, RAYWHITE);
+    DrawText(TextFormat("drones %d", game->drones.count), infoX, textY + 28, 10, RAYWHITE);
+    DrawText(TextFormat("projectiles %d", game->projectiles.count), infoX, textY + 42, 10, RAYWHITE);
+    DrawText(TextFormat("draw calls %d", hud->lastDrawCalls), infoX, textY + 56, 10, RAYWHITE);
 }
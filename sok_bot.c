@@ -0,0 +1,74 @@
+#include "sok_core.h"
+
+//------------------------------------------------------------------------------------
+// Bot Player
+//------------------------------------------------------------------------------------
+// The bot produces the same GameInput a player's mouse does, so its shots go through
+// StepGame exactly like clicks and can be recorded and replayed.
+
+static void RollBotAim(BotPlayer *bot) {
+    bot->aimAtShahed = ((NextRandom(&bot->random) >> 8)*(1.0f/16777216.0f) < bot->accuracy);
+}
+
+// Visible flying drone to shoot next: the Shahed with probability 'accuracy',
+// otherwise one of the decoys. -1 while no suitable drone is on screen.
+static int ChooseBotTarget(BotPlayer *bot, const GameState *state) {
+    const DronePool *drones = &state->drones;
+    int shahed = -1;
+    int decoys[MAX_DRONES];
+    int decoyCount = 0;
+
+    for (int i = 0; i < drones->flyingCount; i++) {
+        Vector2 center = GetDroneBounds(GetDronePosition(drones, i)).center;
+        if (center.x < 0.0f || center.x > SCREEN_WIDTH || center.y < 0.0f || center.y > SCREEN_HEIGHT) continue;
+
+        if (drones->answer[i] == state->currentEquation.correctAnswer) shahed = i;
+        else decoys[decoyCount++] = i;
+    }
+
+    if (bot->aimAtShahed || decoyCount == 0) return shahed;
+    return decoys[GetRandomBelow(&bot->random, decoyCount)];
+}
+
+void InitBotPlayer(BotPlayer *bot, float accuracy, float reactionTime, uint64_t seed) {
+    bot->accuracy = (accuracy < 0.0f) ? 0.0f : (accuracy > 1.0f) ? 1.0f : accuracy;
+    bot->reactionTime = (reactionTime > 0.0f) ? reactionTime : 0.0f;
+    bot->target = (EntityHandle){ -1, 0 };
+    bot->aimTimer = 0.0f;
+    SeedRandomStream(&bot->random, seed, RANDOM_STREAM_BOT);
+    RollBotAim(bot);
+}
+
+// Input for the next 'deltaTime' seconds of play. The bot picks a target, needs
+// reactionTime seconds to aim at it and fires once the Gepard is ready; it keeps
+// the target until that drone is hit or leaves, and restarts after game over.
+GameInput UpdateBotPlayer(BotPlayer *bot, const GameState *state, float deltaTime) {
+    GameInput input = { 0 };
+    input.mousePos = (Vector2){ SCREEN_WIDTH/2.0f, SCREEN_HEIGHT/2.0f };
+
+    // StepGame only acts on it once the game is actually over
+    input.restartPressed = (state->ammo < state->rules.shotCost);
+    if (!state->gameStarted) return input;
+
+    int index = ResolveDroneHandle(&state->drones, bot->target);
+    if (index == -1 || index >= state->drones.flyingCount) {
+        index = ChooseBotTarget(bot, state);
+        if (index == -1) {
+            bot->target = (EntityHandle){ -1, 0 };
+            return input;
+        }
+        bot->target = GetDroneHandle(&state->drones, index);
+        bot->aimTimer = bot->reactionTime;
+        RollBotAim(bot);
+    }
+
+    input.mousePos = GetDroneBounds(GetDronePosition(&state->drones, index)).center;
+
+    bot->aimTimer -= deltaTime;
+    if (bot->aimTimer <= 0.0f && !state->gepard.isFiring && state->ammo >= state->rules.shotCost) {
+        input.firePressed = true;
+        bot->aimTimer = bot->reactionTime;
+    }
+
+    return input;
+}
@@ -0,0 +1,31 @@
+#if !defined(_WIN32)
+    #define _POSIX_C_SOURCE 199309L     // clock_gettime() under -std=c99
+#endif
+
+#include "sok_core.h"
+
+#if defined(_WIN32)
+    // Declared here instead of including windows.h (same approach as raylib)
+    int __stdcall QueryPerformanceCounter(long long *count);
+    int __stdcall QueryPerformanceFrequency(long long *frequency);
+#else
+    #include <time.h>
+#endif
+
+//------------------------------------------------------------------------------------
+// Monotonic Clock
+//------------------------------------------------------------------------------------
+// Nanoseconds from an arbitrary fixed point, for measuring intervals
+uint64_t GetClockNanoseconds(void) {
+#if defined(_WIN32)
+    static long long frequency = 0;
+    if (frequency == 0) QueryPerformanceFrequency(&frequency);
+    long long count;
+    QueryPerformanceCounter(&count);
+    return (uint64_t)(count / frequency) * 1000000000ull + (uint64_t)(count % frequency) * 1000000000ull / (uint64_t)frequency;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
@@ -0,0 +1,1131 @@
+#include "sok_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define SOK_SIMD_SSE
+#endif
+
+//------------------------------------------------------------------------------------
+// Module Functions Declaration
+//------------------------------------------------------------------------------------
+static bool GrowProjectilePool(ProjectilePool *pool);
+static void ScheduleProjectileEvent(ProjectilePool *pool, int index);
+static ProjectileEvent PopProjectileEvent(ProjectilePool *pool);
+static void ReleaseProjectile(ProjectilePool *pool, int index);
+
+//------------------------------------------------------------------------------------
+// Session Control
+//------------------------------------------------------------------------------------
+// NOTE: Only call on a fresh GameState, the projectile pool is not freed here
+void InitGameState(GameState *state, uint64_t seed) {
+    memset(state, 0, sizeof(*state));
+
+    state->seed = seed;
+    SeedRandomStream(&state->equationRandom, seed, RANDOM_STREAM_EQUATIONS);
+    SeedRandomStream(&state->distractorRandom, seed, RANDOM_STREAM_DISTRACTORS);
+    SeedRandomStream(&state->spawnRandom, seed, RANDOM_STREAM_SPAWNS);
+    InitEquationTables();
+
+    state->gepardPosition = (Vector2){ 120.0f, (float)SCREEN_HEIGHT - 40.0f - (GEPARD_TEXTURE_SIZE * GEPARD_SCALE) };
+    state->rules = (GameRules){ INITIAL_AMMO, SHOT_COST, HIT_REWARD, MAX_AMMO };
+    state->ammo = state->rules.initialAmmo;
+    state->level = 1;
+    ClearDrones(&state->drones);
+}
+
+void UnloadGameState(GameState *state) {
+    UnloadProjectiles(&state->projectiles);
+}
+
+void StartGame(GameState *state, int level) {
+    state->level = level;
+    state->gameStarted = true;
+    GenerateNewEquation(&state->currentEquation, state->level, &state->drones, state->allowNegativeResults, &state->equationRandom);
+    SpawnDrones(&state->drones, &state->currentEquation, state->dronesPerWave, state->distractorMode, &state->activeDroneCount, &state->distractorRandom, &state->spawnRandom);
+    state->shahedActive = true;
+}
+
+void StepGame(GameState *state, const GameInput *input, float deltaTime) {
+    state->events = 0;
+    if (!state->gameStarted) return;
+    TRACE_ZONE_BEGIN(zone, "StepGame");
+
+    state->gepard.turretIndex = GetTurretIndexFromMouse(input->mousePos.x, SCREEN_WIDTH);
+
+    // Update gepard animation
+    UpdateGepard(&state->gepard, deltaTime);
+
+    // Update drones
+    UpdateDrones(&state->drones, deltaTime);
+
+    // Update projectiles
+    UpdateProjectiles(&state->projectiles, &state->drones, &state->rules, &state->ammo, &state->score, &state->shahedActive, deltaTime);
+
+    // Spawn timer
+    state->spawnTimer += deltaTime;
+
+    // Check drone status (replaces duplicate logic)
+    DroneStatus droneStatus = CheckDroneStatus(&state->drones);
+
+    // Update shahedActive status
+    if (!droneStatus.shahedFound) {
+        state->shahedActive = false;
+    }
+
+    // Spawn new wave only if Shahed has been dealt with (hit or missed)
+    if (!state->shahedActive && state->spawnTimer > RESPAWN_DELAY) {
+        GenerateNewEquation(&state->currentEquation, state->level, &state->drones, state->allowNegativeResults, &state->equationRandom);
+        SpawnDrones(&state->drones, &state->currentEquation, state->dronesPerWave, state->distractorMode, &state->activeDroneCount, &state->distractorRandom, &state->spawnRandom);
+        state->shahedActive = true;
+        state->spawnTimer = 0.0f;
+    }
+
+    // Handle shooting
+    if (input->firePressed && !state->gepard.isFiring && state->ammo >= state->rules.shotCost) {
+        // Check if clicked on a flying drone
+        DronePool *drones = &state->drones;
+        int i = GetDroneAtPoint(drones, input->mousePos);
+        if (i != -1) {
+            DroneBounds bounds = GetDroneBounds(GetDronePosition(drones, i));
+
+            // Fire at drone
+            state->ammo -= state->rules.shotCost;
+            state->gepard.isFiring = true;
+            state->gepard.fireTimer = 0.0f;
+            state->gepard.fireFrame = 1; // Start at middle frame for immediate visual feedback
+            state->events |= GAME_EVENT_SHOT;
+            // Explosion sound only if hitting the correct drone (Shahed)
+            if (drones->isShahed[i]) {
+                state->events |= GAME_EVENT_EXPLOSION;
+            }
+
+            // Spawn THREE projectiles from tank to drone (dual barrels + center)
+            Vector2 barrelPos1 = GetBarrelPosition(state->gepardPosition, true);
+            Vector2 barrelPos2 = GetBarrelPosition(state->gepardPosition, false);
+            Vector2 barrelPosCenter = {
+                (barrelPos1.x + barrelPos2.x) / 2.0f,
+                (barrelPos1.y + barrelPos2.y) / 2.0f
+            };
+
+            // Target center of drone with slight offset for triple barrels
+            Vector2 droneTarget1 = { bounds.center.x - DRONE_TARGET_OFFSET, bounds.center.y };
+            Vector2 droneTarget2 = { bounds.center.x + DRONE_TARGET_OFFSET, bounds.center.y };
+            Vector2 droneTarget3 = { bounds.center.x, bounds.center.y };
+            EntityHandle droneHandle = GetDroneHandle(drones, i);
+            SpawnProjectile(&state->projectiles, drones, barrelPos1, droneTarget1, droneHandle);
+            SpawnProjectile(&state->projectiles, drones, barrelPos2, droneTarget2, droneHandle);
+            SpawnProjectile(&state->projectiles, drones, barrelPosCenter, droneTarget3, droneHandle);
+        }
+    }
+
+    // Game over check
+    if (state->ammo < state->rules.shotCost) {
+        // Reuse the drone status we already calculated
+        if (!droneStatus.canWin && droneStatus.aliveCount == 0) {
+            // Game over - restart
+            if (input->restartPressed) {
+                // Settings, the projectile pool memory and the random streams survive the
+                // restart, so the next game continues the seeded sequence
+                bool allowNegative = state->allowNegativeResults;
+                DistractorMode distractorMode = state->distractorMode;
+                int dronesPerWave = state->dronesPerWave;
+                GameRules rules = state->rules;
+                ProjectilePool projectiles = state->projectiles;
+                RandomStream equationRandom = state->equationRandom;
+                RandomStream distractorRandom = state->distractorRandom;
+                RandomStream spawnRandom = state->spawnRandom;
+                InitGameState(state, state->seed);
+                state->allowNegativeResults = allowNegative;
+                state->distractorMode = distractorMode;
+                state->dronesPerWave = dronesPerWave;
+                state->rules = rules;
+                state->ammo = rules.initialAmmo;
+                state->projectiles = projectiles;
+                ClearProjectiles(&state->projectiles);
+                state->equationRandom = equationRandom;
+                state->distractorRandom = distractorRandom;
+                state->spawnRandom = spawnRandom;
+            }
+        }
+    }
+
+    TRACE_ZONE_END(zone);
+}
+
+//------------------------------------------------------------------------------------
+// Game Logic Functions
+//------------------------------------------------------------------------------------
+void DecomposeNumber(int num, int *tens, int *ones) {
+    if (num >= 0) {
+        *tens = (num / 10) * 10;
+        *ones = num % 10;
+    } else {
+        // For negative numbers, decompose the absolute value
+        int absNum = -num;
+        *tens = -((absNum / 10) * 10);
+        *ones = -(absNum % 10);
+    }
+}
+
+void CreateDecomposedEquation(MathEquation *eq) {
+    eq->partCount = 0;
+
+    int num1_tens, num1_ones;
+    int num2_tens, num2_ones;
+
+    DecomposeNumber(eq->num1, &num1_tens, &num1_ones);
+    DecomposeNumber(eq->num2, &num2_tens, &num2_ones);
+
+    switch(eq->operation) {
+        case '+': {
+            // For addition: highlight all tens in green
+            // Example: 18 + 23 = 10 + 8 + 10 + 10 + 3
+            int idx = 0;
+
+            // First number decomposition
+            if (num1_tens != 0) {
+                eq->parts[idx].value = num1_tens;
+                eq->parts[idx].operatorBefore = '\0';
+                eq->parts[idx].visualState = PART_HIGHLIGHT; // Green for tens
+                idx++;
+            }
+            if (num1_ones != 0) {
+                eq->parts[idx].value = num1_ones;
+                eq->parts[idx].operatorBefore = (num1_tens != 0) ? '+' : '\0';
+                eq->parts[idx].visualState = PART_NORMAL;
+                idx++;
+            }
+
+            // Second number decomposition
+            if (num2_tens != 0) {
+                eq->parts[idx].value = num2_tens;
+                eq->parts[idx].operatorBefore = '+';
+                eq->parts[idx].visualState = PART_HIGHLIGHT; // Green for tens
+                idx++;
+            }
+            if (num2_ones != 0) {
+                eq->parts[idx].value = num2_ones;
+                eq->parts[idx].operatorBefore = '+';
+                eq->parts[idx].visualState = PART_NORMAL;
+                idx++;
+            }
+
+            eq->partCount = idx;
+            break;
+        }
+
+        case '-': {
+            // For subtraction: implement pairing logic
+            // Example: 11 - 20 = 10 + 1 - 10 - 10
+            //                    (red)    (red)
+            int idx = 0;
+
+            // Build lists of positive and negative tens
+            int positiveTens[10] = {0};
+            int negativeTens[10] = {0};
+            int posTensCount = 0;
+            int negTensCount = 0;
+
+            // Add parts from num1 (all positive)
+            if (num1_tens != 0) {
+                int count = abs(num1_tens) / 10;
+                for (int i = 0; i < count; i++) {
+                    positiveTens[posTensCount++] = 10;
+                }
+            }
+
+            // Add parts from num2 (all negative in subtraction)
+            if (num2_tens != 0) {
+                int count = abs(num2_tens) / 10;
+                for (int i = 0; i < count; i++) {
+                    negativeTens[negTensCount++] = 10;
+                }
+            }
+
+            // Mark pairs for red highlighting (cancellation)
+            bool positiveCancelled[10] = {false};
+            bool negativeCancelled[10] = {false};
+
+            int pairsToMake = (posTensCount < negTensCount) ? posTensCount : negTensCount;
+            for (int i = 0; i < pairsToMake; i++) {
+                positiveCancelled[i] = true;
+                negativeCancelled[i] = true;
+            }
+
+            // Now build the parts array
+            // First number parts
+            if (num1_tens != 0) {
+                int count = abs(num1_tens) / 10;
+                for (int i = 0; i < count; i++) {
+                    eq->parts[idx].value = 10;
+                    eq->parts[idx].operatorBefore = (idx == 0) ? '\0' : '+';
+                    eq->parts[idx].visualState = positiveCancelled[i] ? PART_CANCELLED : PART_NORMAL;
+                    idx++;
+                }
+            }
+
+            if (num1_ones != 0) {
+                eq->parts[idx].value = num1_ones;
+                eq->parts[idx].operatorBefore = (idx == 0) ? '\0' : '+';
+                eq->parts[idx].visualState = PART_NORMAL;
+                idx++;
+            }
+
+            // Second number parts (subtracted)
+            if (num2_tens != 0) {
+                int count = abs(num2_tens) / 10;
+                for (int i = 0; i < count; i++) {
+                    eq->parts[idx].value = 10;
+                    eq->parts[idx].operatorBefore = '-';
+                    eq->parts[idx].visualState = negativeCancelled[i] ? PART_CANCELLED : PART_NORMAL;
+                    idx++;
+                }
+            }
+
+            if (num2_ones != 0) {
+                eq->parts[idx].value = abs(num2_ones);
+                eq->parts[idx].operatorBefore = '-';
+                eq->parts[idx].visualState = PART_NORMAL;
+                idx++;
+            }
+
+            eq->partCount = idx;
+            break;
+        }
+
+        case '*':
+        case '/':
+            // For multiplication and division, create a single "part" with the full equation
+            eq->parts[0].value = eq->num1;
+            eq->parts[0].operatorBefore = '\0';
+            eq->parts[0].visualState = PART_NORMAL;
+            eq->partCount = 1;
+            break;
+    }
+
+    // Also build the old string version for compatibility
+    char buffer[128] = "";
+    for (int i = 0; i < eq->partCount; i++) {
+        if (eq->parts[i].operatorBefore != '\0') {
+            sprintf(buffer + strlen(buffer), " %c ", eq->parts[i].operatorBefore);
+        }
+        sprintf(buffer + strlen(buffer), "%d", eq->parts[i].value);
+    }
+
+    if (eq->operation == '*') {
+        sprintf(buffer, "%d * %d", eq->num1, eq->num2);
+    } else if (eq->operation == '/') {
+        sprintf(buffer, "%d / %d", eq->num1, eq->num2);
+    }
+
+    sprintf(buffer + strlen(buffer), " = ?");
+    strcpy(eq->decomposed, buffer);
+}
+
+// Draw from the level's equation table, leaving out answers already flying
+// (every table answer lies inside the answer index range)
+void GenerateNewEquation(MathEquation *eq, int level, const DronePool *drones, bool allowNegative, RandomStream *random) {
+    int excluded[ANSWER_INDEX_SIZE];
+    int excludedCount = GetFlyingAnswers(drones, excluded, ANSWER_INDEX_SIZE);
+
+    const EquationEntry *entry = SampleEquation(GetEquationTable(level, allowNegative), excluded, excludedCount, random);
+    eq->num1 = entry->num1;
+    eq->num2 = entry->num2;
+    eq->operation = entry->operation;
+    eq->correctAnswer = entry->answer;
+
+    // Create decomposed version of the equation for children
+    CreateDecomposedEquation(eq);
+}
+
+// List a candidate answer unless a flying drone shows it or it is among the first
+// 'checkCount' candidates already listed
+static void AddDistractorCandidate(const DronePool *drones, int *candidates, int *count, int checkCount, int answer) {
+    if (IsAnswerFlying(drones, answer)) return;
+    for (int i = 0; i < checkCount; i++) {
+        if (candidates[i] == answer) return;
+    }
+    candidates[(*count)++] = answer;
+}
+
+// Distinct wrong answers for a wave, none of them already on screen. Candidates are
+// listed in tiers (typical slips in plausible mode, the nearby window, then further out
+// as far as needed) and drawn by a partial Fisher-Yates shuffle that empties a tier
+// before moving on. There are no retries, the cost only grows with the wave size.
+static void PickDistractors(const DronePool *drones, const MathEquation *eq, DistractorMode mode, int *distractors, int count, RandomStream *random) {
+    int candidates[MAX_DRONES + 2*DISTRACTOR_SPREAD + 8];
+    int candidateCount = 0;
+    int tierEnd[3];
+    int tierCount = 0;
+    int answer = eq->correctAnswer;
+
+    if (mode == DISTRACTORS_PLAUSIBLE) {
+        int slips[8] = { answer + 1, answer - 1, answer + 2, answer - 2, answer + 10, answer - 10 };
+        int slipCount = 6;
+        if (eq->operation == '*') {
+            // One row of the times table off
+            slips[slipCount++] = answer + eq->num2;
+            slips[slipCount++] = answer - eq->num2;
+        }
+        for (int i = 0; i < slipCount; i++) AddDistractorCandidate(drones, candidates, &candidateCount, candidateCount, slips[i]);
+        tierEnd[tierCount++] = candidateCount;
+    }
+    int slipsListed = candidateCount;
+
+    for (int offset = 1; offset <= DISTRACTOR_SPREAD; offset++) {
+        AddDistractorCandidate(drones, candidates, &candidateCount, candidateCount, answer - offset);
+        AddDistractorCandidate(drones, candidates, &candidateCount, candidateCount, answer + offset);
+    }
+    tierEnd[tierCount++] = candidateCount;
+
+    // Widen only as far as a crowded screen or a big wave needs
+    for (int offset = DISTRACTOR_SPREAD + 1; candidateCount < count; offset++) {
+        AddDistractorCandidate(drones, candidates, &candidateCount, slipsListed, answer - offset);
+        AddDistractorCandidate(drones, candidates, &candidateCount, slipsListed, answer + offset);
+    }
+    tierEnd[tierCount++] = candidateCount;
+
+    int tier = 0;
+    for (int i = 0; i < count; i++) {
+        while (tierEnd[tier] <= i) tier++;
+        int pick = i + GetRandomBelow(random, tierEnd[tier] - i);
+        distractors[i] = candidates[pick];
+        candidates[pick] = candidates[i];
+    }
+}
+
+void SpawnDrones(DronePool *drones, MathEquation *eq, int dronesPerWave, DistractorMode distractorMode, int *activeDroneCount, RandomStream *distractorRandom, RandomStream *spawnRandom) {
+    int numDrones = (dronesPerWave > 0) ? dronesPerWave :
+                    DRONE_MIN_COUNT + GetRandomBelow(spawnRandom, DRONE_MAX_COUNT - DRONE_MIN_COUNT + 1);
+    if (numDrones > MAX_DRONES - drones->count) numDrones = MAX_DRONES - drones->count;
+    if (numDrones <= 0) {
+        *activeDroneCount = 0;
+        return;
+    }
+    TRACE_ZONE_BEGIN(zone, "SpawnDrones");
+
+    // Mark an existing drone that shows the new correct answer as the Shahed, and make
+    // sure old drones aren't marked as Shahed anymore
+    bool foundExistingShahed = IsAnswerFlying(drones, eq->correctAnswer);
+    for (int i = 0; i < drones->flyingCount; i++) {
+        SetDroneShahed(drones, i, drones->answer[i] == eq->correctAnswer);
+    }
+
+    // If we found an existing drone with correct answer, don't spawn another one with same answer
+    int correctIndex = foundExistingShahed ? -1 : GetRandomBelow(spawnRandom, numDrones);
+
+    int distractors[MAX_DRONES];
+    int distractorCount = numDrones - ((correctIndex >= 0) ? 1 : 0);
+    PickDistractors(drones, eq, distractorMode, distractors, distractorCount, distractorRandom);
+
+    // Append the new wave to the pool. A normal wave flies in one line; a stress wave is
+    // packed into rows, its columns closing up so it never trails off the right edge.
+    int rows = 1;
+    float rowHeight = DRONE_SPAWN_Y_RANGE;
+    float columnSpacing = DRONE_SPAWN_SPACING;
+    if (dronesPerWave > 0) {
+        rows = STRESS_SPAWN_ROWS;
+        rowHeight = DRONE_SPAWN_Y_RANGE / rows;
+        int columns = (numDrones + rows - 1) / rows;
+        if (columns * columnSpacing > STRESS_SPAWN_DEPTH) columnSpacing = STRESS_SPAWN_DEPTH / columns;
+    }
+    for (int i = 0, next = 0; i < numDrones; i++) {
+        Vector2 position = {
+            DRONE_SPAWN_X + (i / rows) * columnSpacing,
+            DRONE_SPAWN_Y_MIN + (i % rows) * rowHeight + GetRandomBelow(spawnRandom, (int)rowHeight)
+        };
+        AddDrone(drones, position, (i == correctIndex) ? eq->correctAnswer : distractors[next++], (i == correctIndex));
+    }
+
+    *activeDroneCount = numDrones;
+    TRACE_ZONE_END(zone);
+}
+
+// Advance every live drone along its state velocity. The arrays are packed and the
+// loop body is branch-free, so it runs four drones per iteration with SSE and the
+// scalar tail (or the whole loop on other targets) auto-vectorizes.
+static void IntegrateDrones(DronePool *pool, float deltaTime) {
+    float *restrict posX = pool->posX;
+    float *restrict posY = pool->posY;
+    float *restrict prevX = pool->prevX;
+    float *restrict prevY = pool->prevY;
+    const float *restrict velX = pool->velX;
+    const float *restrict velY = pool->velY;
+    float *restrict animTimer = pool->animTimer;
+    const int count = pool->count;
+    int i = 0;
+
+#if defined(SOK_SIMD_SSE)
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(posX + i);
+        __m128 y = _mm_loadu_ps(posY + i);
+        _mm_storeu_ps(prevX + i, x);
+        _mm_storeu_ps(prevY + i, y);
+        _mm_storeu_ps(posX + i, _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(velX + i), dt)));
+        _mm_storeu_ps(posY + i, _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(velY + i), dt)));
+        _mm_storeu_ps(animTimer + i, _mm_add_ps(_mm_loadu_ps(animTimer + i), dt));
+    }
+#endif
+
+    for (; i < count; i++) {
+        prevX[i] = posX[i];
+        prevY[i] = posY[i];
+        posX[i] += velX[i] * deltaTime;
+        posY[i] += velY[i] * deltaTime;
+        animTimer[i] += deltaTime;
+    }
+}
+
+void UpdateDrones(DronePool *drones, float deltaTime) {
+    IntegrateDrones(drones, deltaTime);
+
+    // State changes fire from the timing wheel, so drones with nothing due cost nothing
+    AdvanceTimerWheel(&drones->timers, deltaTime);
+
+    int slot;
+    while ((slot = PopExpiredTimer(&drones->timers)) != -1) {
+        int i = drones->packedIndex[slot];
+
+        switch(drones->state[i]) {
+            case DRONE_FLYING:
+                // If Shahed reaches left side, make it fall down
+                if (drones->isShahed[i]) {
+                    SetDroneState(drones, i, DRONE_FALLING);
+                }
+                // Non-Shahed drones just disappear off screen
+                else {
+                    RemoveDrone(drones, i);
+                }
+                break;
+
+            case DRONE_FAKE_DESTRUCTION:
+            case DRONE_EXPLODING:
+                // Animation finished
+                RemoveDrone(drones, i);
+                break;
+
+            case DRONE_FALLING:
+                // If Shahed hits ground, explode
+                if (drones->isShahed[i]) {
+                    SetDroneState(drones, i, DRONE_EXPLODING);
+                    drones->posY[i] += GROUND_EXPLOSION_OFFSET;
+                    drones->prevY[i] = drones->posY[i]; // Jump, don't interpolate
+                }
+                // Non-Shahed drones just disappear when hitting ground or going off screen
+                else {
+                    RemoveDrone(drones, i);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // Keep the spatial grid in step with flying drones (a no-op unless one changed cells)
+    for (int i = 0; i < drones->flyingCount; i++) {
+        UpdateSpatialItem(&drones->grid, drones->slot[i], GetDroneBounds(GetDronePosition(drones, i)).bounds);
+    }
+}
+
+void UpdateGepard(GepardTank *gepard, float deltaTime) {
+    if (gepard->isFiring) {
+        gepard->fireTimer += deltaTime;
+
+        if (gepard->fireTimer > FIRE_FRAME_DURATION) {
+            gepard->fireFrame++;
+            gepard->fireTimer = 0.0f;
+
+            if (gepard->fireFrame > 2) { // 0=normal, 1=middle, 2=top, then back to 0
+                gepard->fireFrame = 0;
+                gepard->isFiring = false;
+            }
+        }
+    }
+}
+
+int GetTurretIndexFromMouse(int mouseX, int screenWidth) {
+    // Map mouse X position to turret index (0-4)
+    // Right edge (screenWidth) -> index 0
+    // Left edge (0) -> index 4
+    float ratio = (float)mouseX / (float)screenWidth;
+    int index = (int)((1.0f - ratio) * 5);
+    if (index < 0) index = 0;
+    if (index > 4) index = 4;
+    return index;
+}
+
+// Earliest time from now the tracer comes within hit range of its target's center,
+// assuming both keep their current velocity. -1 when it never does.
+static double SolveProjectileHit(const Projectile *projectile, const DronePool *drones, int targetIdx) {
+    DroneBounds bounds = GetDroneBounds(GetDronePosition(drones, targetIdx));
+    double radius = bounds.width * PROJECTILE_HIT_RADIUS;
+
+    // Tracer position and velocity relative to the drone center
+    double dx = projectile->position.x - bounds.center.x;
+    double dy = projectile->position.y - bounds.center.y;
+    double wx = projectile->velocity.x - drones->velX[targetIdx];
+    double wy = projectile->velocity.y - drones->velY[targetIdx];
+
+    // Smallest t >= 0 with |d + w*t| = radius
+    double c = dx * dx + dy * dy - radius * radius;
+    if (c < 0.0) return 0.0;                    // Already within range
+    double a = wx * wx + wy * wy;
+    double b = dx * wx + dy * wy;
+    if (a == 0.0 || b >= 0.0) return -1.0;      // Not closing in
+    double discriminant = b * b - a * c;
+    if (discriminant < 0.0) return -1.0;        // Passes wide
+    return (-b - sqrt(discriminant)) / a;
+}
+
+// Time until a tracer leaves the screen or burns out
+static double SolveProjectileExpiry(Vector2 position, Vector2 velocity) {
+    double t = PROJECTILE_MAX_LIFETIME;
+    if (velocity.x > 0.0f) t = fmin(t, (OFF_SCREEN_RIGHT - position.x) / velocity.x);
+    if (velocity.x < 0.0f) t = fmin(t, (OFF_SCREEN_TOP - position.x) / velocity.x);
+    if (velocity.y > 0.0f) t = fmin(t, (OFF_SCREEN_BOTTOM - position.y) / velocity.y);
+    if (velocity.y < 0.0f) t = fmin(t, (OFF_SCREEN_TOP - position.y) / velocity.y);
+    return t;
+}
+
+static void ApplyProjectileHit(DronePool *drones, int targetIdx, const GameRules *rules, int *ammo, int *score, bool *shahedActive) {
+    // Only apply damage effects if still flying (not already hit)
+    if (drones->state[targetIdx] == DRONE_FLYING) {
+        if (drones->isShahed[targetIdx]) {
+            // Correct hit!
+            SetDroneState(drones, targetIdx, DRONE_EXPLODING);
+            *ammo += rules->hitReward;
+            // Cap ammo at maximum
+            if (*ammo > rules->maxAmmo) {
+                *ammo = rules->maxAmmo;
+            }
+            *score += SCORE_CORRECT_HIT;
+            *shahedActive = false; // Shahed destroyed, can generate new equation
+        } else {
+            // Wrong hit - show fake destruction animation
+            SetDroneState(drones, targetIdx, DRONE_FAKE_DESTRUCTION);
+            *score += SCORE_WRONG_HIT; // Note: SCORE_WRONG_HIT is -5
+        }
+    }
+}
+
+// Returns the new projectile's handle, slot -1 only if the pool could not grow
+EntityHandle SpawnProjectile(ProjectilePool *projectiles, const DronePool *drones, Vector2 start, Vector2 target, EntityHandle targetDrone) {
+    if (projectiles->freeCount == 0 && !GrowProjectilePool(projectiles)) {
+        projectiles->droppedCount++;
+        return (EntityHandle){ -1, 0 };
+    }
+
+    int slot = projectiles->freeSlots[--projectiles->freeCount];
+    int index = projectiles->count++;
+    projectiles->slot[index] = slot;
+    projectiles->packedIndex[slot] = index;
+    if (projectiles->count > projectiles->highWater) projectiles->highWater = projectiles->count;
+
+    Projectile *projectile = &projectiles->items[index];
+    projectile->position = start;
+    projectile->prevPosition = start;
+    projectile->velocity = (Vector2){ 0.0f, 0.0f };
+    projectile->target = targetDrone;
+
+    // Calculate velocity toward target
+    Vector2 direction = { target.x - start.x, target.y - start.y };
+    float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
+    if (length > 0) {
+        projectile->velocity.x = (direction.x / length) * PROJECTILE_SPEED;
+        projectile->velocity.y = (direction.y / length) * PROJECTILE_SPEED;
+    }
+
+    // Both tracer and drone move in straight lines, so the whole flight is known now
+    projectile->expireTime = projectiles->time + SolveProjectileExpiry(start, projectile->velocity);
+    projectile->hitTime = -1.0;
+    int targetIdx = ResolveDroneHandle(drones, targetDrone);
+    if (targetIdx >= 0) {
+        double t = SolveProjectileHit(projectile, drones, targetIdx);
+        if (t >= 0.0) projectile->hitTime = projectiles->time + t;
+        projectile->targetState = drones->state[targetIdx];
+    }
+    ScheduleProjectileEvent(projectiles, index);
+
+    return (EntityHandle){ slot, projectiles->generation[slot] };
+}
+
+// Move tracers for drawing, then run the hits and expiries that came due this step
+void UpdateProjectiles(ProjectilePool *projectiles, DronePool *drones, const GameRules *rules, int *ammo, int *score, bool *shahedActive, float deltaTime) {
+    for (int i = 0; i < projectiles->count; i++) {
+        Projectile *projectile = &projectiles->items[i];
+        projectile->prevPosition = projectile->position;
+        projectile->position.x += projectile->velocity.x * deltaTime;
+        projectile->position.y += projectile->velocity.y * deltaTime;
+    }
+    projectiles->time += deltaTime;
+
+    while (projectiles->eventCount > 0 && projectiles->events[0].time <= projectiles->time) {
+        ProjectileEvent event = PopProjectileEvent(projectiles);
+        Projectile *projectile = ResolveProjectileHandle(projectiles, event.projectile);
+        if (projectile == NULL) continue;
+        int index = projectiles->packedIndex[event.projectile.slot];
+
+        if (projectile->hitTime >= 0.0) {
+            // The handle goes stale once the target died, even if a new drone took its slot
+            int targetIdx = ResolveDroneHandle(drones, projectile->target);
+            bool hittable = (targetIdx >= 0) &&
+                (drones->state[targetIdx] == DRONE_FLYING || drones->state[targetIdx] == DRONE_EXPLODING);
+
+            if (hittable && drones->state[targetIdx] != projectile->targetState) {
+                // Target changed course since the hit was scheduled, solve again from here
+                double t = SolveProjectileHit(projectile, drones, targetIdx);
+                projectile->targetState = drones->state[targetIdx];
+                if (t > 0.0) {
+                    projectile->hitTime = projectiles->time + t;
+                    ScheduleProjectileEvent(projectiles, index);
+                    continue;
+                }
+                hittable = (t == 0.0);
+            }
+
+            if (hittable) {
+                ReleaseProjectile(projectiles, index);
+                ApplyProjectileHit(drones, targetIdx, rules, ammo, score, shahedActive);
+            } else {
+                // Missed, fly on until off-screen
+                projectile->hitTime = -1.0;
+                ScheduleProjectileEvent(projectiles, index);
+            }
+        } else {
+            // Off-screen or lived too long
+            ReleaseProjectile(projectiles, index);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Projectile Pool
+//------------------------------------------------------------------------------------
+// Add PROJECTILE_POOL_CHUNK free slots, false when out of memory
+static bool GrowProjectilePool(ProjectilePool *pool) {
+    int capacity = pool->capacity + PROJECTILE_POOL_CHUNK;
+
+#define GROW_FIELD(field) { void *grown = realloc(pool->field, (size_t)capacity * sizeof(*pool->field)); if (grown == NULL) return false; pool->field = grown; }
+    GROW_FIELD(items);
+    GROW_FIELD(slot);
+    GROW_FIELD(packedIndex);
+    GROW_FIELD(generation);
+    GROW_FIELD(freeSlots);
+    GROW_FIELD(events);
+#undef GROW_FIELD
+
+    // Only called with an empty free stack, push the new slots with the lowest on top
+    for (int slot = capacity - 1; slot >= pool->capacity; slot--) {
+        pool->packedIndex[slot] = -1;
+        pool->generation[slot] = 1;
+        pool->freeSlots[pool->freeCount++] = slot;
+    }
+    pool->capacity = capacity;
+    pool->growCount++;
+
+    return true;
+}
+
+// Release every projectile but keep the memory (and statistics) for reuse
+void ClearProjectiles(ProjectilePool *pool) {
+    for (int i = 0; i < pool->count; i++) {
+        int slot = pool->slot[i];
+        pool->packedIndex[slot] = -1;
+        pool->generation[slot]++;
+    }
+    pool->count = 0;
+    pool->eventCount = 0;
+    pool->time = 0.0;
+
+    pool->freeCount = pool->capacity;
+    for (int i = 0; i < pool->capacity; i++) {
+        pool->freeSlots[i] = pool->capacity - 1 - i;
+    }
+}
+
+void UnloadProjectiles(ProjectilePool *pool) {
+    free(pool->items);
+    free(pool->slot);
+    free(pool->packedIndex);
+    free(pool->generation);
+    free(pool->freeSlots);
+    free(pool->events);
+    memset(pool, 0, sizeof(*pool));
+}
+
+// Remove the projectile at a packed index, the last one moves into its place.
+// Only called for the projectile whose event was just popped, so no stale events pile up.
+static void ReleaseProjectile(ProjectilePool *pool, int index) {
+    int slot = pool->slot[index];
+    int last = --pool->count;
+
+    pool->items[index] = pool->items[last];
+    pool->slot[index] = pool->slot[last];
+    pool->packedIndex[pool->slot[index]] = index;
+
+    pool->packedIndex[slot] = -1;
+    pool->generation[slot]++;
+    pool->freeSlots[pool->freeCount++] = slot;
+}
+
+// Queue the projectile's next event: its hit if it has one, else its expiry
+static void ScheduleProjectileEvent(ProjectilePool *pool, int index) {
+    Projectile *projectile = &pool->items[index];
+    if (projectile->hitTime > projectile->expireTime) projectile->hitTime = -1.0;
+
+    int slot = pool->slot[index];
+    ProjectileEvent event = {
+        (projectile->hitTime >= 0.0) ? projectile->hitTime : projectile->expireTime,
+        { slot, pool->generation[slot] }
+    };
+
+    // Sift up
+    int i = pool->eventCount++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (pool->events[parent].time <= event.time) break;
+        pool->events[i] = pool->events[parent];
+        i = parent;
+    }
+    pool->events[i] = event;
+}
+
+static ProjectileEvent PopProjectileEvent(ProjectilePool *pool) {
+    ProjectileEvent top = pool->events[0];
+    ProjectileEvent last = pool->events[--pool->eventCount];
+
+    // Sift the last event down from the root
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= pool->eventCount) break;
+        if (child + 1 < pool->eventCount && pool->events[child + 1].time < pool->events[child].time) child++;
+        if (last.time <= pool->events[child].time) break;
+        pool->events[i] = pool->events[child];
+        i = child;
+    }
+    if (pool->eventCount > 0) pool->events[i] = last;
+
+    return top;
+}
+
+// Projectile a handle refers to, NULL once it has been released. The pointer is only
+// good until the next spawn or release.
+Projectile *ResolveProjectileHandle(ProjectilePool *pool, EntityHandle handle) {
+    if (handle.slot < 0 || handle.slot >= pool->capacity) return NULL;
+    if (pool->generation[handle.slot] != handle.generation) return NULL;
+    if (pool->packedIndex[handle.slot] < 0) return NULL;   // Free slot, e.g. one never handed out
+    return &pool->items[pool->packedIndex[handle.slot]];
+}
+
+//------------------------------------------------------------------------------------
+// Drone Pool
+//------------------------------------------------------------------------------------
+static void SwapDrones(DronePool *pool, int a, int b) {
+    if (a == b) return;
+
+#define SWAP_FIELD(type, field) { type tmp = pool->field[a]; pool->field[a] = pool->field[b]; pool->field[b] = tmp; }
+    SWAP_FIELD(float, posX);
+    SWAP_FIELD(float, posY);
+    SWAP_FIELD(float, prevX);
+    SWAP_FIELD(float, prevY);
+    SWAP_FIELD(float, velX);
+    SWAP_FIELD(float, velY);
+    SWAP_FIELD(float, animTimer);
+    SWAP_FIELD(int, answer);
+    SWAP_FIELD(unsigned char, state);
+    SWAP_FIELD(bool, isShahed);
+    SWAP_FIELD(int, slot);
+#undef SWAP_FIELD
+
+    pool->packedIndex[pool->slot[a]] = a;
+    pool->packedIndex[pool->slot[b]] = b;
+}
+
+// Time the drone's next state change for its current state. Velocities only change
+// along with the state, so positional limits can be solved for up front.
+static void ScheduleDroneTransition(DronePool *pool, int index) {
+    float x = pool->posX[index];
+    float y = pool->posY[index];
+    float delay;
+
+    switch (pool->state[index]) {
+        case DRONE_FLYING:
+            // Shaheds start falling at the left boundary, the others fly off screen
+            delay = (x - (pool->isShahed[index] ? DRONE_LEFT_BOUNDARY : OFF_SCREEN_LEFT)) / -pool->velX[index];
+            break;
+
+        case DRONE_FAKE_DESTRUCTION:
+            delay = FAKE_DESTRUCTION_FRAME_DURATION * 3.0f;
+            break;
+
+        case DRONE_EXPLODING:
+            delay = EXPLOSION_FRAME_DURATION * 5.0f;
+            break;
+
+        case DRONE_FALLING:
+            // Shaheds explode on the ground, the others vanish near it or off screen
+            if (pool->isShahed[index]) {
+                delay = (GROUND_LEVEL - y) / pool->velY[index];
+            } else {
+                delay = fminf((NEAR_GROUND_LEVEL - y) / pool->velY[index], (x - OFF_SCREEN_LEFT) / -pool->velX[index]);
+            }
+            break;
+
+        default:
+            CancelTimer(&pool->timers, pool->slot[index]);
+            return;
+    }
+
+    ScheduleTimer(&pool->timers, pool->slot[index], delay);
+}
+
+// Answers outside the index range are not tracked, IsAnswerFlying scans for those
+static void IndexFlyingAnswer(DronePool *pool, int answer) {
+    int bit = answer - ANSWER_INDEX_MIN;
+    if (bit < 0 || bit >= ANSWER_INDEX_SIZE) return;
+    if (pool->answerCount[bit]++ == 0) pool->answerBits[bit/64] |= 1ull << (bit%64);
+}
+
+static void UnindexFlyingAnswer(DronePool *pool, int answer) {
+    int bit = answer - ANSWER_INDEX_MIN;
+    if (bit < 0 || bit >= ANSWER_INDEX_SIZE) return;
+    if (--pool->answerCount[bit] == 0) pool->answerBits[bit/64] &= ~(1ull << (bit%64));
+}
+
+void ClearDrones(DronePool *pool) {
+    pool->count = 0;
+    pool->flyingCount = 0;
+    memset(pool->answerBits, 0, sizeof(pool->answerBits));
+    memset(pool->answerCount, 0, sizeof(pool->answerCount));
+
+    // Free stack holds slot 0 on top so slots are handed out in order
+    pool->freeCount = MAX_DRONES;
+    for (int i = 0; i < MAX_DRONES; i++) {
+        pool->packedIndex[i] = -1;
+        pool->generation[i] = 1;
+        pool->freeSlots[i] = MAX_DRONES - 1 - i;
+    }
+    InitSpatialGrid(&pool->grid);
+    InitTimerWheel(&pool->timers);
+}
+
+// Add a flying drone, returns its packed index (-1 when the pool is full)
+int AddDrone(DronePool *pool, Vector2 position, int answer, bool isShahed) {
+    if (pool->freeCount == 0) return -1;
+
+    int slot = pool->freeSlots[--pool->freeCount];
+
+    int index = pool->count++;
+    pool->slot[index] = slot;
+    pool->packedIndex[slot] = index;
+
+    // Keep flying drones grouped at the front
+    SwapDrones(pool, index, pool->flyingCount);
+    index = pool->flyingCount++;
+
+    pool->posX[index] = position.x;
+    pool->posY[index] = position.y;
+    pool->prevX[index] = position.x;
+    pool->prevY[index] = position.y;
+    pool->answer[index] = answer;
+    pool->isShahed[index] = isShahed;
+    pool->state[index] = DRONE_FLYING;
+    pool->velX[index] = -DRONE_SPEED;
+    pool->velY[index] = 0.0f;
+    pool->animTimer[index] = 0.0f;
+
+    UpdateSpatialItem(&pool->grid, slot, GetDroneBounds(position).bounds);
+    IndexFlyingAnswer(pool, answer);
+    ScheduleDroneTransition(pool, index);
+
+    return index;
+}
+
+// Move a drone to a new state and restart its animation. Leaving DRONE_FLYING moves
+// the drone out of the flying group, so the drone at 'index' changes.
+void SetDroneState(DronePool *pool, int index, DroneState state) {
+    if (state == DRONE_DEAD) {
+        RemoveDrone(pool, index);
+        return;
+    }
+
+    if (index < pool->flyingCount && state != DRONE_FLYING) {
+        // Only flying drones can be picked or block answers, drop it from both indexes
+        RemoveSpatialItem(&pool->grid, pool->slot[index]);
+        UnindexFlyingAnswer(pool, pool->answer[index]);
+        SwapDrones(pool, index, pool->flyingCount - 1);
+        index = --pool->flyingCount;
+    }
+
+    pool->state[index] = (unsigned char)state;
+    pool->animTimer[index] = 0.0f;
+
+    switch (state) {
+        case DRONE_FAKE_DESTRUCTION:
+            // Drift left slightly and fall FAKE_DESTRUCTION_FALL_DISTANCE over the 3 frames
+            pool->velX[index] = -DRONE_SPEED * 0.3f;
+            pool->velY[index] = FAKE_DESTRUCTION_FALL_DISTANCE / (FAKE_DESTRUCTION_FRAME_DURATION * 3.0f);
+            break;
+
+        case DRONE_FALLING:
+            pool->velX[index] = -DRONE_SPEED * DRONE_FALL_HORIZONTAL_MULTIPLIER;
+            pool->velY[index] = DRONE_FALL_SPEED;
+            break;
+
+        case DRONE_EXPLODING:
+            pool->velX[index] = 0.0f;
+            pool->velY[index] = 0.0f;
+            break;
+
+        default:
+            pool->velX[index] = -DRONE_SPEED;
+            pool->velY[index] = 0.0f;
+            break;
+    }
+
+    ScheduleDroneTransition(pool, index);
+}
+
+// Mark a drone as the Shahed or clear the mark. Where a flying drone leaves the screen
+// depends on it, so its pending state change is timed again.
+void SetDroneShahed(DronePool *pool, int index, bool isShahed) {
+    if (pool->isShahed[index] == isShahed) return;
+    pool->isShahed[index] = isShahed;
+    ScheduleDroneTransition(pool, index);
+}
+
+// Remove a drone, filling its place from the end of its group
+void RemoveDrone(DronePool *pool, int index) {
+    RemoveSpatialItem(&pool->grid, pool->slot[index]);
+    CancelTimer(&pool->timers, pool->slot[index]);
+
+    if (index < pool->flyingCount) {
+        UnindexFlyingAnswer(pool, pool->answer[index]);
+        SwapDrones(pool, index, pool->flyingCount - 1);
+        index = --pool->flyingCount;
+    }
+
+    int last = pool->count - 1;
+    SwapDrones(pool, index, last);
+    pool->count--;
+
+    // Release the slot, invalidating every handle to this drone
+    int slot = pool->slot[last];
+    pool->packedIndex[slot] = -1;
+    pool->generation[slot]++;
+    pool->freeSlots[pool->freeCount++] = slot;
+}
+
+Drone GetDrone(const DronePool *pool, int index) {
+    Drone drone;
+    drone.position = (Vector2){ pool->posX[index], pool->posY[index] };
+    drone.prevPosition = (Vector2){ pool->prevX[index], pool->prevY[index] };
+    drone.answer = pool->answer[index];
+    drone.isShahed = pool->isShahed[index];
+    drone.state = (DroneState)pool->state[index];
+    drone.animTimer = pool->animTimer[index];
+    return drone;
+}
+
+Vector2 GetDronePosition(const DronePool *pool, int index) {
+    return (Vector2){ pool->posX[index], pool->posY[index] };
+}
+
+EntityHandle GetDroneHandle(const DronePool *pool, int index) {
+    int slot = pool->slot[index];
+    return (EntityHandle){ slot, pool->generation[slot] };
+}
+
+// Packed index of the drone a handle refers to, -1 once that drone is gone
+int ResolveDroneHandle(const DronePool *pool, EntityHandle handle) {
+    if (handle.slot < 0 || handle.slot >= MAX_DRONES) return -1;
+    if (pool->generation[handle.slot] != handle.generation) return -1;
+    return pool->packedIndex[handle.slot];
+}
+
+// Is a flying drone showing this answer? One bit test for answers in the index range.
+bool IsAnswerFlying(const DronePool *pool, int answer) {
+    int bit = answer - ANSWER_INDEX_MIN;
+    if (bit >= 0 && bit < ANSWER_INDEX_SIZE) return (pool->answerBits[bit/64] >> (bit%64)) & 1;
+
+    for (int i = 0; i < pool->flyingCount; i++) {
+        if (pool->answer[i] == answer) return true;
+    }
+    return false;
+}
+
+// Distinct answers of flying drones in ascending order, returns how many were written.
+// Only answers in the index range are listed.
+int GetFlyingAnswers(const DronePool *pool, int *answers, int maxAnswers) {
+    int count = 0;
+    for (int word = 0; word < ANSWER_INDEX_WORDS; word++) {
+        uint64_t bits = pool->answerBits[word];
+        for (int bit = 0; bits != 0 && count < maxAnswers; bit++, bits >>= 1) {
+            if (bits & 1) answers[count++] = ANSWER_INDEX_MIN + word*64 + bit;
+        }
+    }
+    return count;
+}
+
+// Flying drone under a point (lowest packed index when several overlap), -1 if none
+int GetDroneAtPoint(const DronePool *pool, Vector2 point) {
+    int slots[64];
+    int found = QuerySpatialPoint(&pool->grid, point, slots, 64);
+
+    int best = -1;
+    for (int i = 0; i < found; i++) {
+        int index = pool->packedIndex[slots[i]];
+        if (best == -1 || index < best) best = index;
+    }
+    return best;
+}
+
+//------------------------------------------------------------------------------------
+// Helper Function Implementations
+//------------------------------------------------------------------------------------
+
+DroneBounds GetDroneBounds(Vector2 position) {
+    DroneBounds bounds;
+    bounds.width = DRONE_TEXTURE_SIZE * DRONE_SCALE;
+    bounds.height = DRONE_TEXTURE_SIZE * DRONE_SCALE;
+    bounds.center.x = position.x + bounds.width / 2.0f;
+    bounds.center.y = position.y + bounds.height / 2.0f;
+    bounds.bounds = (Rectangle){ position.x, position.y, bounds.width, bounds.height };
+    return bounds;
+}
+
+DroneStatus CheckDroneStatus(const DronePool *drones) {
+    DroneStatus status = {false, false, 0};
+    // Every drone in the pool is alive, dead ones are removed immediately
+    status.aliveCount = drones->count;
+    for (int i = 0; i < drones->flyingCount; i++) {
+        if (drones->isShahed[i]) {
+            status.shahedFound = true;
+            status.canWin = true;
+            break;
+        }
+    }
+    return status;
+}
+
+Vector2 GetBarrelPosition(Vector2 gepardPos, bool isLeftBarrel) {
+    float barrelX = isLeftBarrel ? GEPARD_BARREL_LEFT_X : GEPARD_BARREL_RIGHT_X;
+    return (Vector2){
+        gepardPos.x + (GEPARD_TEXTURE_SIZE * GEPARD_SCALE * barrelX),
+        gepardPos.y + (GEPARD_TEXTURE_SIZE * GEPARD_SCALE * GEPARD_BARREL_Y)
+    };
+}
+
+Vector2 InterpolatePosition(Vector2 previous, Vector2 current, float alpha) {
+    return (Vector2){
+        previous.x + (current.x - previous.x) * alpha,
+        previous.y + (current.y - previous.y) * alpha
+    };
+}
@@ -0,0 +1,602 @@
+#ifndef SOK_CORE_H
+#define SOK_CORE_H
+
+// Headless simulation core: all game state and the update path, with no window,
+// GPU or audio dependency. The game front-end (main.c) and headless tools link
+// against this as the sok_core static library.
+//
+// NOTE: When used together with raylib, include raylib.h before this header so the
+// shared Vector2/Rectangle types are taken from raylib (same convention as raymath).
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------------
+// Game configuration
+#define MAX_DRONES 4096         // Drone pool capacity (stress mode spawns thousands)
+#define PROJECTILE_POOL_CHUNK 32 // Projectile pool grows by this many slots at a time
+#define INITIAL_AMMO 10
+
+// Gameplay constants
+#define SHOT_COST 2
+#define HIT_REWARD 3
+#define SCORE_CORRECT_HIT 10
+#define SCORE_WRONG_HIT -5
+#define MAX_AMMO 20
+
+// Physics constants
+#define DRONE_SPEED 70.0f
+#define PROJECTILE_SPEED 3000.0f
+#define DRONE_FALL_SPEED 150.0f
+#define DRONE_FALL_HORIZONTAL_MULTIPLIER 0.5f
+#define PROJECTILE_HIT_RADIUS 0.3f
+#define PROJECTILE_MAX_LIFETIME 2.0f
+
+// Sprite scaling constants
+#define DRONE_SCALE 2.0f        // Drone sprite scale (1.5 = 150%)
+#define GEPARD_SCALE 2.0f       // Gepard tank scale (2.0 = 200%)
+#define GEPARD_TEXTURE_SIZE 150 // Original Gepard texture size (150x150)
+#define DRONE_TEXTURE_SIZE 100  // Original drone texture size (100x100)
+
+// Screen and layout constants
+#define SCREEN_WIDTH 1107
+#define SCREEN_HEIGHT 694
+#define GROUND_LEVEL 394.0f
+#define GROUND_EXPLOSION_OFFSET 200.0f
+#define NEAR_GROUND_LEVEL 494.0f
+
+// Gepard barrel positions (as ratios of sprite size)
+#define GEPARD_BARREL_LEFT_X 0.67f
+#define GEPARD_BARREL_RIGHT_X 0.83f
+#define GEPARD_BARREL_Y 0.63f
+
+// Drone spawn constants
+#define DRONE_SPAWN_X 1200.0f
+#define DRONE_SPAWN_SPACING 150.0f
+#define DRONE_SPAWN_Y_MIN 80.0f
+#define DRONE_SPAWN_Y_RANGE 250.0f
+#define DRONE_MIN_COUNT 2
+#define DRONE_MAX_COUNT 2
+#define STRESS_SPAWN_ROWS 16            // Stress waves spawn as a block of rows over the spawn height...
+#define STRESS_SPAWN_DEPTH 350.0f       // ...at most this wide, so the whole wave is on the field in about 5 s
+
+// Distractor answers (wrong answers on decoy drones)
+#define DISTRACTOR_SPREAD 10            // Nearby distractors lie within this distance of the answer
+
+// Drone target offsets for dual barrels
+#define DRONE_TARGET_OFFSET 10.0f
+
+// Animation timing
+#define FIRE_FRAME_DURATION 0.05f
+#define FAKE_DESTRUCTION_FRAME_DURATION 0.15f  // Duration per frame for fake destruction (cells 2-4)
+#define FAKE_DESTRUCTION_FALL_DISTANCE 200.0f  // How far fake shaheds fall during destruction
+#define EXPLOSION_FRAME_DURATION 0.08f         // Duration per frame for explosion (cells 6-10)
+
+// Fixed-step simulation timing
+#define SIM_TICK_RATE 120                       // Simulation steps per second
+#define SIM_FIXED_DT (1.0f / SIM_TICK_RATE)
+#define MAX_SIM_STEPS_PER_FRAME 8               // Drop simulated time beyond this after a long hitch
+
+// Spawn timing
+#define SPAWN_INTERVAL 3.0f
+#define RESPAWN_DELAY 1.0f
+
+// Spatial grid over the play field (cells must be at least as large as a drone)
+#define SPATIAL_CELL_SIZE 200
+#define SPATIAL_GRID_COLS ((SCREEN_WIDTH + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE)
+#define SPATIAL_GRID_ROWS ((SCREEN_HEIGHT + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE)
+#define SPATIAL_CELLS_PER_ITEM 4    // An item no larger than a cell overlaps at most 2x2 cells
+
+// Timing wheel for scheduled drone state changes (one tick per simulation step)
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_BITS 6                      // 64 slots per level
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MAX_DELAY ((1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS)) - (1u << ((TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_BITS)))
+
+// Answers on flying drones, indexed for duplicate checks (covers every equation answer
+// plus the distractor spread around it)
+#define ANSWER_INDEX_MIN -256
+#define ANSWER_INDEX_SIZE 1024                  // Answers ANSWER_INDEX_MIN to ANSWER_INDEX_MIN + 1023
+#define ANSWER_INDEX_WORDS (ANSWER_INDEX_SIZE/64)
+
+// Equation tables
+#define EQUATION_MAX_OPS 4                      // +, -, * and /
+#define EQUATION_TABLE_CAPACITY 28386           // Entries of all six level/negative tables
+
+// Trace capture
+#define TRACE_MAX_EVENTS (1 << 20)              // Zones kept per capture (24 bytes each)
+
+// Soak test
+#define FRAME_HISTOGRAM_BUCKETS (39*64)         // Frame times up to 2^44 ns (almost 5 hours)
+#define SOAK_REPORT_INTERVAL 60.0               // Seconds between progress lines
+#define SOAK_HEADLESS_FRAME_STEPS (SIM_TICK_RATE/60)    // Simulation steps per headless frame
+
+// Bot player defaults
+#define BOT_DEFAULT_ACCURACY 0.9f
+#define BOT_DEFAULT_REACTION_TIME 0.5f          // Seconds
+
+// Off-screen boundaries
+#define OFF_SCREEN_LEFT -150.0f
+#define OFF_SCREEN_RIGHT 1200.0f
+#define OFF_SCREEN_TOP -10.0f
+#define OFF_SCREEN_BOTTOM 750.0f
+#define DRONE_LEFT_BOUNDARY 100.0f
+
+//------------------------------------------------------------------------------------
+// Types and Structures Definition
+//------------------------------------------------------------------------------------
+#if !defined(RL_VECTOR2_TYPE)
+// Vector2, 2 components (layout-compatible with raylib)
+typedef struct Vector2 {
+    float x;
+    float y;
+} Vector2;
+#define RL_VECTOR2_TYPE
+#endif
+
+#if !defined(RL_RECTANGLE_TYPE)
+// Rectangle, 4 components (layout-compatible with raylib)
+typedef struct Rectangle {
+    float x;
+    float y;
+    float width;
+    float height;
+} Rectangle;
+#define RL_RECTANGLE_TYPE
+#endif
+
+typedef enum {
+    DRONE_FLYING = 0,
+    DRONE_FAKE_DESTRUCTION, // Non-shahed drones show fake destruction (cells 2-4)
+    DRONE_EXPLODING,        // Real explosion animation (cells 6-10)
+    DRONE_FALLING,
+    DRONE_DEAD
+} DroneState;
+
+// Uniform grid answering point and segment queries over the play field. Items are
+// identified by an integer id in [0, MAX_DRONES) and linked into every cell they
+// overlap through intrusive lists, so moving an item only touches the cells it
+// enters or leaves. Items entirely outside the field are not indexed.
+typedef struct SpatialGrid {
+    int cellHead[SPATIAL_GRID_COLS * SPATIAL_GRID_ROWS];    // First node in each cell, -1 when empty
+    int nodeNext[MAX_DRONES * SPATIAL_CELLS_PER_ITEM];      // Node id = item id * SPATIAL_CELLS_PER_ITEM + k
+    int nodePrev[MAX_DRONES * SPATIAL_CELLS_PER_ITEM];
+
+    Rectangle rect[MAX_DRONES];
+    signed char minCol[MAX_DRONES];     // Cell range of each item, minCol -1 when not indexed
+    signed char minRow[MAX_DRONES];
+    signed char maxCol[MAX_DRONES];
+    signed char maxRow[MAX_DRONES];
+
+    unsigned int visitStamp[MAX_DRONES];    // De-duplicates items spanning several cells in a query
+    unsigned int queryStamp;
+} SpatialGrid;
+
+// Random number stream (xoshiro128** state). The simulation never touches libc rand(),
+// each subsystem draws from its own stream so a seed reproduces a session exactly.
+typedef struct RandomStream {
+    uint32_t s[4];
+} RandomStream;
+
+typedef enum {
+    RANDOM_STREAM_EQUATIONS = 1,    // Operation and operands of each equation
+    RANDOM_STREAM_DISTRACTORS,      // Wrong answers carried by decoy drones
+    RANDOM_STREAM_SPAWNS,           // Wave size, Shahed slot and spawn heights
+    RANDOM_STREAM_BOT               // Target choices of the bot player
+} RandomStreamId;
+
+// Hierarchical timing wheel holding at most one pending timer per id in [0, MAX_DRONES).
+// Level 0 has one slot per tick; each higher level has one slot per full turn of the
+// level below and is cascaded down as time reaches it, so scheduling, cancelling and
+// firing are all O(1) and ids without a pending timer cost nothing.
+typedef struct TimerWheel {
+    unsigned int tick;      // Current tick
+    float tickFraction;     // Time advanced but not yet a whole tick
+
+    // Bucket = level * TIMER_WHEEL_SLOTS + slot, the last bucket lists expired timers
+    int bucketHead[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1];
+    int next[MAX_DRONES];
+    int prev[MAX_DRONES];
+    short bucket[MAX_DRONES];           // -1 when the id has no pending timer
+    unsigned int expires[MAX_DRONES];   // Tick the timer fires on
+} TimerWheel;
+
+// Generation-tagged reference to a pooled drone or projectile. Releasing an entity
+// bumps the generation of its slot, so old handles go stale even once the slot is
+// reused. Generations start at 1, so a zeroed handle is never valid.
+typedef struct EntityHandle {
+    int slot;
+    unsigned int generation;
+} EntityHandle;
+
+// Snapshot of a single drone, assembled from the pool for drawing
+typedef struct Drone {
+    Vector2 position;
+    Vector2 prevPosition;   // Position at the start of the last step (for render interpolation)
+    int answer;
+    bool isShahed;
+    DroneState state;
+    float animTimer;
+} Drone;
+
+// Structure-of-arrays drone storage. Live drones are packed in [0, count) and grouped
+// by state: flying drones always occupy [0, flyingCount). Motion is a per-state
+// velocity so UpdateDrones integrates every drone with one branch-free loop.
+typedef struct DronePool {
+    int count;
+    int flyingCount;
+
+    // Motion, integrated together
+    float posX[MAX_DRONES];
+    float posY[MAX_DRONES];
+    float prevX[MAX_DRONES];        // Position at the start of the last step
+    float prevY[MAX_DRONES];
+    float velX[MAX_DRONES];         // Set from the state on every state change
+    float velY[MAX_DRONES];
+    float animTimer[MAX_DRONES];
+
+    // Per-drone attributes
+    int answer[MAX_DRONES];
+    unsigned char state[MAX_DRONES];    // DroneState
+    bool isShahed[MAX_DRONES];
+
+    // Packed indices move as drones change state or die, so other entities refer to
+    // drones by EntityHandle (stable slot id + generation) instead
+    int slot[MAX_DRONES];               // Packed index -> slot id
+    int packedIndex[MAX_DRONES];        // Slot id -> packed index, -1 when the slot is free
+    unsigned int generation[MAX_DRONES];    // Slot id -> current generation
+    int freeSlots[MAX_DRONES];          // Stack of unused slot ids
+    int freeCount;
+
+    SpatialGrid grid;               // Flying drones by slot id, kept in sync by the pool functions
+    TimerWheel timers;              // Next state change of each drone by slot id, set by the pool functions
+
+    // Answers of flying drones, kept in sync by the pool functions: a bit per answer
+    // plus a count, as two drones can share an answer when a wave runs out of choices
+    uint64_t answerBits[ANSWER_INDEX_WORDS];
+    unsigned short answerCount[ANSWER_INDEX_SIZE];
+} DronePool;
+
+typedef struct {
+    int turretIndex;    // 0-4, which turret position
+    float fireTimer;
+    bool isFiring;
+    int fireFrame;      // 0 = bottom, 1 = middle, 2 = top
+} GepardTank;
+
+typedef enum {
+    PART_NORMAL = 0,    // Normal display (blue)
+    PART_CANCELLED,     // Cancelled pairs (red)
+    PART_HIGHLIGHT      // Highlighted tens in addition (green)
+} PartVisualState;
+
+typedef struct {
+    int value;
+    char operatorBefore; // '+', '-', or '\0' for first element
+    PartVisualState visualState;
+} DecomposedPart;
+
+typedef struct {
+    int num1;
+    int num2;
+    char operation;
+    int correctAnswer;
+    char decomposed[128]; // String representation of decomposed equation
+    DecomposedPart parts[20]; // Individual parts for visual rendering
+    int partCount;
+} MathEquation;
+
+// One valid equation of a level's table
+typedef struct EquationEntry {
+    short num1;
+    short num2;
+    short answer;
+    char operation;
+} EquationEntry;
+
+// All valid equations of one level and negative-results setting, grouped by operation
+// (entries [opStart[op], opStart[op + 1])) and sorted by answer within each group
+typedef struct EquationTable {
+    const EquationEntry *entries;
+    int opStart[EQUATION_MAX_OPS + 1];
+    int opCount;
+} EquationTable;
+
+typedef struct {
+    Vector2 position;
+    Vector2 prevPosition;   // Position at the start of the last step (for render interpolation)
+    Vector2 velocity;
+    EntityHandle target;    // Drone aimed at
+    unsigned char targetState;  // Target's DroneState when the hit was scheduled
+    double hitTime;         // Pool time the tracer reaches its target, -1 if it misses
+    double expireTime;      // Pool time the tracer leaves the screen or burns out
+} Projectile;
+
+// Next thing that happens to a projectile, whichever of hitTime/expireTime comes first
+typedef struct ProjectileEvent {
+    double time;
+    EntityHandle projectile;
+} ProjectileEvent;
+
+// Growable projectile storage. Live projectiles are packed in [0, count) so updates
+// never visit free slots, while slot ids stay stable for handles. A zeroed pool is
+// valid and empty: memory is allocated on first spawn and freed by UnloadProjectiles.
+typedef struct ProjectilePool {
+    Projectile *items;          // Packed live projectiles
+    int *slot;                  // Packed index -> slot id
+    int *packedIndex;           // Slot id -> packed index, -1 when the slot is free
+    unsigned int *generation;   // Slot id -> current generation
+    int *freeSlots;             // Stack of unused slot ids
+    int freeCount;
+    int count;
+    int capacity;
+
+    // Every live projectile has exactly one pending event, kept in a binary min-heap
+    ProjectileEvent *events;    // Same capacity as the pool
+    int eventCount;
+    double time;                // Pool clock, advanced by UpdateProjectiles
+
+    // Statistics (survive ClearProjectiles)
+    int highWater;              // Most projectiles alive at once
+    int growCount;              // Times the pool had to grow
+    int droppedCount;           // Spawns lost because growing failed
+} ProjectilePool;
+
+typedef struct {
+    float width;
+    float height;
+    Vector2 center;
+    Rectangle bounds;
+} DroneBounds;
+
+typedef struct {
+    bool shahedFound;
+    bool canWin;
+    int aliveCount;
+} DroneStatus;
+
+// Side effects raised during a StepGame call, consumed by the front-end (e.g. for sounds)
+typedef enum {
+    GAME_EVENT_SHOT      = 1 << 0,  // Gepard fired a volley
+    GAME_EVENT_EXPLOSION = 1 << 1   // Volley was aimed at the Shahed
+} GameEvent;
+
+// Per-step player input, already mapped to virtual screen coordinates
+typedef struct {
+    Vector2 mousePos;
+    bool firePressed;       // Left mouse button pressed this step
+    bool restartPressed;    // Restart key pressed this step
+} GameInput;
+
+// How SpawnDrones picks the wrong answers of a wave
+typedef enum {
+    DISTRACTORS_NEARBY = 0,     // Uniform within DISTRACTOR_SPREAD of the answer
+    DISTRACTORS_PLAUSIBLE       // Typical slips first (off by one, two or ten, a neighbouring product), then nearby
+} DistractorMode;
+
+// Ammo economy of a session. InitGameState sets the defaults above; balancing tools
+// may change them (and ammo to match initialAmmo) before the game starts.
+typedef struct GameRules {
+    int initialAmmo;
+    int shotCost;
+    int hitReward;
+    int maxAmmo;
+} GameRules;
+
+// Complete simulation state of one game session
+typedef struct GameState {
+    GepardTank gepard;
+    Vector2 gepardPosition;
+
+    DronePool drones;
+    int activeDroneCount;
+    int dronesPerWave;      // 0 = normal game (DRONE_MIN_COUNT..DRONE_MAX_COUNT), more for stress mode
+
+    ProjectilePool projectiles;
+
+    MathEquation currentEquation;
+    GameRules rules;
+    int ammo;
+    int score;
+    int level;
+    bool shahedActive;      // Track if Shahed from current equation is still active
+    float spawnTimer;
+
+    bool allowNegativeResults;
+    DistractorMode distractorMode;
+    bool gameStarted;       // Cleared again when the player restarts after game over
+
+    uint64_t seed;          // Seed the random streams were derived from
+    RandomStream equationRandom;
+    RandomStream distractorRandom;
+    RandomStream spawnRandom;
+
+    unsigned int events;    // GameEvent flags raised by the last StepGame
+} GameState;
+
+// Replay files hold everything that drives the simulation: the session settings,
+// level starts, option changes and the input and delta time of every step
+typedef enum {
+    REPLAY_RECORD_STEP = 1,
+    REPLAY_RECORD_START,
+    REPLAY_RECORD_OPTIONS
+} ReplayRecordType;
+
+typedef struct ReplayRecord {
+    ReplayRecordType type;
+    float deltaTime;            // REPLAY_RECORD_STEP
+    GameInput input;
+    uint32_t checksum;          // Game state checksum after the step when it was recorded
+    int level;                  // REPLAY_RECORD_START
+    bool allowNegativeResults;  // REPLAY_RECORD_OPTIONS
+} ReplayRecord;
+
+typedef struct ReplayFile {
+    void *handle;               // FILE *
+    bool recording;
+    uint64_t seed;              // Session settings from the header
+    int dronesPerWave;
+    bool allowNegativeResults;
+    DistractorMode distractorMode;
+    unsigned int stepCount;     // Steps written or played so far
+    unsigned int firstMismatch; // First played step whose checksum differed (1-based), 0 if none
+} ReplayFile;
+
+// Automated player, see UpdateBotPlayer
+typedef struct BotPlayer {
+    float accuracy;         // Chance of going for the Shahed rather than a decoy (0..1)
+    float reactionTime;     // Seconds to aim at a new target and between shots
+    RandomStream random;
+    EntityHandle target;
+    float aimTimer;
+    bool aimAtShahed;       // Rolled against accuracy for the next target
+} BotPlayer;
+
+// Frame time distribution with fixed memory, however long the run
+typedef struct FrameHistogram {
+    uint64_t counts[FRAME_HISTOGRAM_BUCKETS];
+    uint64_t frameCount;
+    uint64_t maxNs;
+} FrameHistogram;
+
+// Long-running frame time and memory measurement, see BeginSoakTest
+typedef struct SoakTest {
+    FrameHistogram total;
+    FrameHistogram window;      // Frames since the last progress line
+    uint64_t budgetNs;
+    uint64_t overBudgetCount;
+    uint64_t windowOverBudget;
+    uint64_t durationNs;
+    uint64_t startTime;
+    uint64_t lastFrameTime;
+    uint64_t lastReportTime;
+    long startRssKB;            // -1 where resident memory can't be queried
+    long peakRssKB;
+} SoakTest;
+
+// Scope being timed for the trace capture, see TRACE_ZONE_BEGIN
+typedef struct TraceZone {
+    const char *name;       // Stored by pointer, use string literals
+    uint64_t start;         // 0 when no capture was running as the zone began
+} TraceZone;
+
+// Trace zones time a scope for Chrome trace-event export. Every TRACE_ZONE_BEGIN
+// needs a matching TRACE_ZONE_END on each path out of the scope. Without SOK_TRACE
+// defined both compile to nothing; with it, a zone costs a flag check while no
+// capture runs.
+#if defined(SOK_TRACE)
+    #define TRACE_ZONE_BEGIN(zone, name) TraceZone zone = BeginTraceZone(name)
+    #define TRACE_ZONE_END(zone) EndTraceZone(&(zone))
+#else
+    #define TRACE_ZONE_BEGIN(zone, name) ((void)0)
+    #define TRACE_ZONE_END(zone) ((void)0)
+#endif
+
+//------------------------------------------------------------------------------------
+// Function Declarations
+//------------------------------------------------------------------------------------
+// Session control
+// NOTE: GameState holds the full drone pool, give it static or heap storage
+void InitGameState(GameState *state, uint64_t seed);
+void UnloadGameState(GameState *state);
+void StartGame(GameState *state, int level);
+void StepGame(GameState *state, const GameInput *input, float deltaTime);
+
+// Game logic functions
+void DecomposeNumber(int num, int *tens, int *ones);
+void CreateDecomposedEquation(MathEquation *eq);
+void GenerateNewEquation(MathEquation *eq, int level, const DronePool *drones, bool allowNegative, RandomStream *random);
+void SpawnDrones(DronePool *drones, MathEquation *eq, int dronesPerWave, DistractorMode distractorMode, int *activeDroneCount, RandomStream *distractorRandom, RandomStream *spawnRandom);
+void UpdateDrones(DronePool *drones, float deltaTime);
+void UpdateGepard(GepardTank *gepard, float deltaTime);
+void UpdateProjectiles(ProjectilePool *projectiles, DronePool *drones, const GameRules *rules, int *ammo, int *score, bool *shahedActive, float deltaTime);
+EntityHandle SpawnProjectile(ProjectilePool *projectiles, const DronePool *drones, Vector2 start, Vector2 target, EntityHandle targetDrone);
+int GetTurretIndexFromMouse(int mouseX, int screenWidth);
+
+// Equation table functions (sok_equation.c)
+void InitEquationTables(void);
+const EquationTable *GetEquationTable(int level, bool allowNegative);
+const EquationEntry *SampleEquation(const EquationTable *table, const int *excluded, int excludedCount, RandomStream *random);
+
+// Drone pool functions
+void ClearDrones(DronePool *pool);
+int AddDrone(DronePool *pool, Vector2 position, int answer, bool isShahed);
+void SetDroneState(DronePool *pool, int index, DroneState state);
+void SetDroneShahed(DronePool *pool, int index, bool isShahed);
+void RemoveDrone(DronePool *pool, int index);
+Drone GetDrone(const DronePool *pool, int index);
+Vector2 GetDronePosition(const DronePool *pool, int index);
+int GetDroneAtPoint(const DronePool *pool, Vector2 point);
+EntityHandle GetDroneHandle(const DronePool *pool, int index);
+int ResolveDroneHandle(const DronePool *pool, EntityHandle handle);
+bool IsAnswerFlying(const DronePool *pool, int answer);
+int GetFlyingAnswers(const DronePool *pool, int *answers, int maxAnswers);
+
+// Projectile pool functions
+void ClearProjectiles(ProjectilePool *pool);
+void UnloadProjectiles(ProjectilePool *pool);
+Projectile *ResolveProjectileHandle(ProjectilePool *pool, EntityHandle handle);
+
+// Spatial grid functions (sok_spatial.c)
+void InitSpatialGrid(SpatialGrid *grid);
+void UpdateSpatialItem(SpatialGrid *grid, int id, Rectangle rect);
+void RemoveSpatialItem(SpatialGrid *grid, int id);
+int QuerySpatialPoint(const SpatialGrid *grid, Vector2 point, int *results, int maxResults);
+int QuerySpatialSegment(SpatialGrid *grid, Vector2 start, Vector2 end, int *results, int maxResults);
+
+// Random stream functions (sok_random.c)
+void SeedRandomStream(RandomStream *stream, uint64_t seed, unsigned int streamId);
+uint32_t NextRandom(RandomStream *stream);
+int GetRandomBelow(RandomStream *stream, int bound);
+
+// Replay functions (sok_replay.c)
+uint32_t GetGameStateChecksum(const GameState *state);
+bool BeginReplayRecording(ReplayFile *replay, const char *fileName, const GameState *state);
+void RecordReplayStart(ReplayFile *replay, int level);
+void RecordReplayOptions(ReplayFile *replay, bool allowNegativeResults);
+void RecordReplayStep(ReplayFile *replay, const GameInput *input, float deltaTime, const GameState *state);
+bool OpenReplay(ReplayFile *replay, const char *fileName);
+void InitGameFromReplay(GameState *state, const ReplayFile *replay);
+bool PlayReplayRecord(ReplayFile *replay, GameState *state, ReplayRecord *record);
+void CloseReplay(ReplayFile *replay);
+
+// Clock functions (sok_clock.c)
+uint64_t GetClockNanoseconds(void);
+
+// Soak test functions (sok_soak.c)
+void ResetFrameHistogram(FrameHistogram *histogram);
+void AddFrameTime(FrameHistogram *histogram, uint64_t nanoseconds);
+double GetFrameTimePercentile(const FrameHistogram *histogram, double percentile);
+long GetResidentMemoryKB(void);
+void BeginSoakTest(SoakTest *soak, double durationSeconds, double budgetSeconds);
+bool UpdateSoakTest(SoakTest *soak);
+void PrintSoakReport(const SoakTest *soak);
+void RunHeadlessSoak(SoakTest *soak, GameState *state, BotPlayer *bot);
+
+// Bot player functions (sok_bot.c)
+void InitBotPlayer(BotPlayer *bot, float accuracy, float reactionTime, uint64_t seed);
+GameInput UpdateBotPlayer(BotPlayer *bot, const GameState *state, float deltaTime);
+
+// Trace functions (sok_trace.c)
+void BeginTraceCapture(void);
+bool EndTraceCapture(const char *fileName);
+bool IsTraceCapturing(void);
+TraceZone BeginTraceZone(const char *name);
+void EndTraceZone(const TraceZone *zone);
+
+// Timing wheel functions (sok_timer.c)
+void InitTimerWheel(TimerWheel *wheel);
+void ScheduleTimer(TimerWheel *wheel, int id, float delay);
+void CancelTimer(TimerWheel *wheel, int id);
+void AdvanceTimerWheel(TimerWheel *wheel, float deltaTime);
+int PopExpiredTimer(TimerWheel *wheel);
+
+// Helper functions to reduce redundant calculations
+DroneBounds GetDroneBounds(Vector2 position);
+DroneStatus CheckDroneStatus(const DronePool *drones);
+Vector2 GetBarrelPosition(Vector2 gepardPos, bool isLeftBarrel);
+Vector2 InterpolatePosition(Vector2 previous, Vector2 current, float alpha);
+
+#endif // SOK_CORE_H
@@ -0,0 +1,157 @@
+#include "sok_core.h"
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------------
+// Equation Tables
+//------------------------------------------------------------------------------------
+// Every valid equation for each level and negative-results setting, built once. Within
+// a table the entries are grouped by operation and sorted by answer, so the entries
+// with a given answer form one contiguous range that sampling can step over.
+#define EQUATION_TABLE_LEVELS 3     // Levels 3 and up share the last set of tables
+
+static EquationEntry entryStorage[EQUATION_TABLE_CAPACITY];
+static EquationTable tables[EQUATION_TABLE_LEVELS][2];
+static bool tablesBuilt = false;
+
+static int CompareEquationEntries(const void *a, const void *b) {
+    const EquationEntry *x = (const EquationEntry *)a;
+    const EquationEntry *y = (const EquationEntry *)b;
+    if (x->answer != y->answer) return (x->answer > y->answer) - (x->answer < y->answer);
+    if (x->num1 != y->num1) return (x->num1 > y->num1) - (x->num1 < y->num1);
+    return (x->num2 > y->num2) - (x->num2 < y->num2);
+}
+
+static void AddEquationEntry(int *count, int num1, char operation, int num2, int answer) {
+    EquationEntry *entry = &entryStorage[(*count)++];
+    entry->num1 = (short)num1;
+    entry->num2 = (short)num2;
+    entry->answer = (short)answer;
+    entry->operation = operation;
+}
+
+// Operand ranges per level, trivial equations (X+0, 0+X, X-0) are left out
+static void BuildEquationTable(EquationTable *table, int level, bool allowNegative, int *count) {
+    table->entries = &entryStorage[*count];
+    table->opCount = 0;
+    int base = *count;
+
+    // Addition
+    table->opStart[table->opCount++] = *count - base;
+    int addMin = (level == 1) ? 1 : 5;
+    int addMax = (level == 1) ? 20 : 49;
+    for (int a = addMin; a <= addMax; a++)
+        for (int b = addMin; b <= addMax; b++) AddEquationEntry(count, a, '+', b, a + b);
+
+    // Subtraction
+    table->opStart[table->opCount++] = *count - base;
+    if (allowNegative) {
+        int subMax = (level == 1) ? 20 : 79;
+        for (int a = 0; a <= subMax; a++)
+            for (int b = 1; b <= subMax; b++) AddEquationEntry(count, a, '-', b, a - b);
+    } else if (level == 1) {
+        for (int a = 0; a <= 20; a++)
+            for (int b = 1; b <= a; b++) AddEquationEntry(count, a, '-', b, a - b);
+    } else {
+        for (int a = 20; a <= 79; a++)
+            for (int b = 5; b <= a; b++) AddEquationEntry(count, a, '-', b, a - b);
+    }
+
+    // Multiplication from level 2
+    if (level >= 2) {
+        table->opStart[table->opCount++] = *count - base;
+        for (int a = 2; a <= 13; a++)
+            for (int b = 2; b <= 13; b++) AddEquationEntry(count, a, '*', b, a * b);
+    }
+
+    // Division from level 3, always a whole answer
+    if (level >= 3) {
+        table->opStart[table->opCount++] = *count - base;
+        for (int answer = 2; answer <= 11; answer++)
+            for (int divisor = 2; divisor <= 10; divisor++) AddEquationEntry(count, answer * divisor, '/', divisor, answer);
+    }
+    table->opStart[table->opCount] = *count - base;
+
+    for (int op = 0; op < table->opCount; op++) {
+        qsort(&entryStorage[base + table->opStart[op]], table->opStart[op + 1] - table->opStart[op],
+              sizeof(EquationEntry), CompareEquationEntries);
+    }
+}
+
+// NOTE: InitGameState calls this, call it (or InitGameState) once before starting
+// threads that generate equations, the tables are read-only after that
+void InitEquationTables(void) {
+    if (tablesBuilt) return;
+
+    int count = 0;
+    for (int level = 1; level <= EQUATION_TABLE_LEVELS; level++) {
+        BuildEquationTable(&tables[level - 1][0], level, false, &count);
+        BuildEquationTable(&tables[level - 1][1], level, true, &count);
+    }
+    tablesBuilt = true;
+}
+
+const EquationTable *GetEquationTable(int level, bool allowNegative) {
+    InitEquationTables();
+    int index = (level == 1) ? 0 : (level == 2) ? 1 : 2;
+    return &tables[index][allowNegative ? 1 : 0];
+}
+
+// First entry in [low, high) whose answer is not below 'answer'
+static int FindAnswer(const EquationEntry *entries, int low, int high, int answer) {
+    while (low < high) {
+        int middle = low + (high - low)/2;
+        if (entries[middle].answer < answer) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+// Entries of operation 'op' left once the excluded answers are taken out
+static int CountAvailableEntries(const EquationTable *table, int op, const int *excluded, int excludedCount) {
+    int low = table->opStart[op];
+    int high = table->opStart[op + 1];
+    int available = high - low;
+    for (int i = 0; i < excludedCount; i++) {
+        available -= FindAnswer(table->entries, low, high, excluded[i] + 1) - FindAnswer(table->entries, low, high, excluded[i]);
+    }
+    return available;
+}
+
+// Uniformly pick an operation that still has equations left, then uniformly one of its
+// equations whose answer is not in 'excluded' (sorted ascending, no repeats). If every
+// answer is excluded the exclusion is dropped. Cost is bounded by the excluded count,
+// never by retries.
+const EquationEntry *SampleEquation(const EquationTable *table, const int *excluded, int excludedCount, RandomStream *random) {
+    int available[EQUATION_MAX_OPS];
+    int usableOps = 0;
+    for (int op = 0; op < table->opCount; op++) {
+        available[op] = CountAvailableEntries(table, op, excluded, excludedCount);
+        if (available[op] > 0) usableOps++;
+    }
+
+    if (usableOps == 0) {
+        int op = GetRandomBelow(random, table->opCount);
+        int size = table->opStart[op + 1] - table->opStart[op];
+        return &table->entries[table->opStart[op] + GetRandomBelow(random, size)];
+    }
+
+    int pick = GetRandomBelow(random, usableOps);
+    int op = 0;
+    while (available[op] == 0 || pick > 0) {
+        if (available[op] > 0) pick--;
+        op++;
+    }
+
+    // Step over the excluded answers' ranges that lie at or before the picked position
+    int low = table->opStart[op];
+    int high = table->opStart[op + 1];
+    int index = low + GetRandomBelow(random, available[op]);
+    for (int i = 0; i < excludedCount; i++) {
+        int start = FindAnswer(table->entries, low, high, excluded[i]);
+        int end = FindAnswer(table->entries, start, high, excluded[i] + 1);
+        if (start > index) break;
+        index += end - start;
+    }
+
+    return &table->entries[index];
+}
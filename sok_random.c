@@ -0,0 +1,62 @@
+#include "sok_core.h"
+
+//------------------------------------------------------------------------------------
+// Random Streams (xoshiro128**, seeded through splitmix64)
+//------------------------------------------------------------------------------------
+static uint64_t SplitMix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint32_t RotateLeft(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// Every (seed, streamId) pair gives an unrelated sequence
+void SeedRandomStream(RandomStream *stream, uint64_t seed, unsigned int streamId) {
+    uint64_t state = seed ^ ((uint64_t)streamId * 0xD1B54A32D192ED03ull);
+    uint64_t a = SplitMix64(&state);
+    uint64_t b = SplitMix64(&state);
+    stream->s[0] = (uint32_t)a;
+    stream->s[1] = (uint32_t)(a >> 32);
+    stream->s[2] = (uint32_t)b;
+    stream->s[3] = (uint32_t)(b >> 32);
+
+    // All-zero state is the one invalid state, splitmix64 practically never yields it
+    if ((stream->s[0] | stream->s[1] | stream->s[2] | stream->s[3]) == 0) stream->s[0] = 1;
+}
+
+uint32_t NextRandom(RandomStream *stream) {
+    uint32_t *s = stream->s;
+    uint32_t result = RotateLeft(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft(s[3], 11);
+
+    return result;
+}
+
+// Uniform value in [0, bound), drop-in for rand() % bound (bound <= 0 gives 0).
+// Multiply-shift with Lemire's rejection step: the few low products that would favour
+// some values are redrawn, which only costs a division when one comes up at all.
+int GetRandomBelow(RandomStream *stream, int bound) {
+    if (bound <= 0) return 0;
+
+    uint32_t range = (uint32_t)bound;
+    uint64_t product = (uint64_t)NextRandom(stream) * range;
+    if ((uint32_t)product < range) {
+        uint32_t threshold = (0u - range) % range;
+        while ((uint32_t)product < threshold) {
+            product = (uint64_t)NextRandom(stream) * range;
+        }
+    }
+
+    return (int)(product >> 32);
+}
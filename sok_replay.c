@@ -0,0 +1,248 @@
+#include "sok_core.h"
+#include <stdio.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------------
+// Replay Files
+//------------------------------------------------------------------------------------
+// Layout (all values little-endian):
+//   header: "SOKR", u16 version, u8 allowNegativeResults, u8 distractorMode, u64 seed, i32 dronesPerWave
+//   records: u8 type, then
+//     REPLAY_RECORD_STEP:    f32 deltaTime, f32 mouseX, f32 mouseY, u8 buttons, u32 checksum
+//     REPLAY_RECORD_START:   u8 level
+//     REPLAY_RECORD_OPTIONS: u8 allowNegativeResults
+#define REPLAY_MAGIC "SOKR"
+#define REPLAY_VERSION 6        // Bumped whenever the simulation changes what a recording replays to
+
+#define REPLAY_BUTTON_FIRE 0x01
+#define REPLAY_BUTTON_RESTART 0x02
+
+static void WriteU8(FILE *file, unsigned int value) {
+    fputc((int)(value & 0xFF), file);
+}
+
+static void WriteU32(FILE *file, uint32_t value) {
+    unsigned char bytes[4] = { value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, (value >> 24) & 0xFF };
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static void WriteF32(FILE *file, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU32(file, bits);
+}
+
+static bool ReadU8(FILE *file, unsigned int *value) {
+    int c = fgetc(file);
+    if (c == EOF) return false;
+    *value = (unsigned int)c;
+    return true;
+}
+
+static bool ReadU32(FILE *file, uint32_t *value) {
+    unsigned char bytes[4];
+    if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) return false;
+    *value = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    return true;
+}
+
+static bool ReadF32(FILE *file, float *value) {
+    uint32_t bits;
+    if (!ReadU32(file, &bits)) return false;
+    memcpy(value, &bits, sizeof(*value));
+    return true;
+}
+
+// FNV-1a over the raw bytes of a value
+static uint32_t HashBytes(uint32_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+#define HASH_VALUE(hash, value) hash = HashBytes(hash, &(value), sizeof(value))
+
+// Checksum over everything that shapes the rest of the session. Only live entries of
+// the pools are hashed, so it does not depend on stale data in free slots.
+uint32_t GetGameStateChecksum(const GameState *state) {
+    uint32_t hash = 2166136261u;
+
+    HASH_VALUE(hash, state->score);
+    HASH_VALUE(hash, state->ammo);
+    HASH_VALUE(hash, state->level);
+    HASH_VALUE(hash, state->spawnTimer);
+    HASH_VALUE(hash, state->shahedActive);
+    HASH_VALUE(hash, state->gameStarted);
+    HASH_VALUE(hash, state->currentEquation.num1);
+    HASH_VALUE(hash, state->currentEquation.num2);
+    HASH_VALUE(hash, state->currentEquation.correctAnswer);
+    HASH_VALUE(hash, state->equationRandom);
+    HASH_VALUE(hash, state->distractorRandom);
+    HASH_VALUE(hash, state->spawnRandom);
+
+    const DronePool *drones = &state->drones;
+    HASH_VALUE(hash, drones->count);
+    HASH_VALUE(hash, drones->flyingCount);
+    hash = HashBytes(hash, drones->posX, drones->count * sizeof(float));
+    hash = HashBytes(hash, drones->posY, drones->count * sizeof(float));
+    hash = HashBytes(hash, drones->answer, drones->count * sizeof(int));
+    hash = HashBytes(hash, drones->state, drones->count * sizeof(unsigned char));
+    hash = HashBytes(hash, drones->isShahed, drones->count * sizeof(bool));
+
+    const ProjectilePool *projectiles = &state->projectiles;
+    HASH_VALUE(hash, projectiles->count);
+    for (int i = 0; i < projectiles->count; i++) {
+        HASH_VALUE(hash, projectiles->items[i].position);
+    }
+
+    return hash;
+}
+
+// Start recording a session whose state was just set up with InitGameState
+bool BeginReplayRecording(ReplayFile *replay, const char *fileName, const GameState *state) {
+    memset(replay, 0, sizeof(*replay));
+
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) return false;
+
+    replay->handle = file;
+    replay->recording = true;
+    replay->seed = state->seed;
+    replay->dronesPerWave = state->dronesPerWave;
+    replay->allowNegativeResults = state->allowNegativeResults;
+    replay->distractorMode = state->distractorMode;
+
+    fwrite(REPLAY_MAGIC, 1, 4, file);
+    WriteU8(file, REPLAY_VERSION & 0xFF);
+    WriteU8(file, REPLAY_VERSION >> 8);
+    WriteU8(file, replay->allowNegativeResults);
+    WriteU8(file, (unsigned int)replay->distractorMode);
+    WriteU32(file, (uint32_t)replay->seed);
+    WriteU32(file, (uint32_t)(replay->seed >> 32));
+    WriteU32(file, (uint32_t)replay->dronesPerWave);
+
+    return true;
+}
+
+void RecordReplayStart(ReplayFile *replay, int level) {
+    if (!replay->recording) return;
+    WriteU8(replay->handle, REPLAY_RECORD_START);
+    WriteU8(replay->handle, (unsigned int)level);
+}
+
+void RecordReplayOptions(ReplayFile *replay, bool allowNegativeResults) {
+    if (!replay->recording) return;
+    WriteU8(replay->handle, REPLAY_RECORD_OPTIONS);
+    WriteU8(replay->handle, allowNegativeResults);
+}
+
+// Record a step right after StepGame ran it, together with the resulting checksum
+void RecordReplayStep(ReplayFile *replay, const GameInput *input, float deltaTime, const GameState *state) {
+    if (!replay->recording) return;
+
+    unsigned int buttons = 0;
+    if (input->firePressed) buttons |= REPLAY_BUTTON_FIRE;
+    if (input->restartPressed) buttons |= REPLAY_BUTTON_RESTART;
+
+    FILE *file = replay->handle;
+    WriteU8(file, REPLAY_RECORD_STEP);
+    WriteF32(file, deltaTime);
+    WriteF32(file, input->mousePos.x);
+    WriteF32(file, input->mousePos.y);
+    WriteU8(file, buttons);
+    WriteU32(file, GetGameStateChecksum(state));
+    replay->stepCount++;
+}
+
+// Open a recording for playback, false if it is missing or not a replay file
+bool OpenReplay(ReplayFile *replay, const char *fileName) {
+    memset(replay, 0, sizeof(*replay));
+
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return false;
+
+    char magic[4];
+    unsigned int versionLow, versionHigh, allowNegative, distractorMode;
+    uint32_t seedLow, seedHigh, dronesPerWave;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, REPLAY_MAGIC, 4) != 0 ||
+        !ReadU8(file, &versionLow) || !ReadU8(file, &versionHigh) ||
+        (versionLow | (versionHigh << 8)) != REPLAY_VERSION ||
+        !ReadU8(file, &allowNegative) || !ReadU8(file, &distractorMode) ||
+        !ReadU32(file, &seedLow) || !ReadU32(file, &seedHigh) || !ReadU32(file, &dronesPerWave)) {
+        fclose(file);
+        return false;
+    }
+
+    replay->handle = file;
+    replay->seed = ((uint64_t)seedHigh << 32) | seedLow;
+    replay->dronesPerWave = (int)dronesPerWave;
+    replay->allowNegativeResults = (allowNegative != 0);
+    replay->distractorMode = (DistractorMode)distractorMode;
+
+    return true;
+}
+
+// Set up a fresh session matching the one the replay was recorded from
+void InitGameFromReplay(GameState *state, const ReplayFile *replay) {
+    InitGameState(state, replay->seed);
+    state->dronesPerWave = replay->dronesPerWave;
+    state->allowNegativeResults = replay->allowNegativeResults;
+    state->distractorMode = replay->distractorMode;
+}
+
+// Read the next record and apply it to the game. Steps are checked against the
+// recorded checksum, the first one that differs is kept in firstMismatch.
+// Returns false at the end of the file (or on a truncated record).
+bool PlayReplayRecord(ReplayFile *replay, GameState *state, ReplayRecord *record) {
+    FILE *file = replay->handle;
+    unsigned int type, value;
+
+    memset(record, 0, sizeof(*record));
+    if (!ReadU8(file, &type)) return false;
+    record->type = (ReplayRecordType)type;
+
+    switch (record->type) {
+        case REPLAY_RECORD_STEP: {
+            unsigned int buttons;
+            if (!ReadF32(file, &record->deltaTime) ||
+                !ReadF32(file, &record->input.mousePos.x) || !ReadF32(file, &record->input.mousePos.y) ||
+                !ReadU8(file, &buttons) || !ReadU32(file, &record->checksum)) {
+                return false;
+            }
+            record->input.firePressed = (buttons & REPLAY_BUTTON_FIRE) != 0;
+            record->input.restartPressed = (buttons & REPLAY_BUTTON_RESTART) != 0;
+
+            StepGame(state, &record->input, record->deltaTime);
+            replay->stepCount++;
+            if (replay->firstMismatch == 0 && GetGameStateChecksum(state) != record->checksum) {
+                replay->firstMismatch = replay->stepCount;
+            }
+        } break;
+
+        case REPLAY_RECORD_START:
+            if (!ReadU8(file, &value)) return false;
+            record->level = (int)value;
+            StartGame(state, record->level);
+            break;
+
+        case REPLAY_RECORD_OPTIONS:
+            if (!ReadU8(file, &value)) return false;
+            record->allowNegativeResults = (value != 0);
+            state->allowNegativeResults = record->allowNegativeResults;
+            break;
+
+        default:
+            return false;   // Corrupt file
+    }
+
+    return true;
+}
+
+void CloseReplay(ReplayFile *replay) {
+    if (replay->handle != NULL) fclose(replay->handle);
+    replay->handle = NULL;
+    replay->recording = false;
+}
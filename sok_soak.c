@@ -0,0 +1,196 @@
+#if !defined(_WIN32)
+    #define _POSIX_C_SOURCE 200112L     // sysconf() under -std=c99
+#endif
+
+#include "sok_core.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    // Declared here instead of including windows.h/psapi.h (same approach as raylib)
+    typedef struct ProcessMemoryCounters {
+        unsigned long cb;
+        unsigned long pageFaultCount;
+        size_t peakWorkingSetSize;
+        size_t workingSetSize;
+        size_t quotaPeakPagedPoolUsage;
+        size_t quotaPagedPoolUsage;
+        size_t quotaPeakNonPagedPoolUsage;
+        size_t quotaNonPagedPoolUsage;
+        size_t pagefileUsage;
+        size_t peakPagefileUsage;
+    } ProcessMemoryCounters;
+    void *__stdcall GetCurrentProcess(void);
+    int __stdcall K32GetProcessMemoryInfo(void *process, ProcessMemoryCounters *counters, unsigned long size);
+#elif defined(__linux__)
+    #include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------
+// Frame Time Histogram
+//------------------------------------------------------------------------------------
+// Log-linear buckets over nanoseconds: exact below 128 ns, above that 64 buckets per
+// power of two (under 1.6% error), which covers hours in a fixed table. Headless
+// frames take well under a microsecond, rendered ones many milliseconds.
+#define SUB_BUCKET_BITS 6
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+
+static int GetHistogramBucket(uint64_t nanoseconds) {
+    if (nanoseconds < 2*SUB_BUCKETS) return (int)nanoseconds;
+
+    int shift = 0;
+    while ((nanoseconds >> shift) >= 2*SUB_BUCKETS) shift++;
+    int bucket = 2*SUB_BUCKETS + (shift - 1)*SUB_BUCKETS + (int)((nanoseconds >> shift) - SUB_BUCKETS);
+    return (bucket < FRAME_HISTOGRAM_BUCKETS) ? bucket : FRAME_HISTOGRAM_BUCKETS - 1;
+}
+
+// Middle of the range of frame times a bucket holds, in nanoseconds
+static double GetHistogramBucketValue(int bucket) {
+    if (bucket < 2*SUB_BUCKETS) return (double)bucket;
+
+    int shift = (bucket - 2*SUB_BUCKETS)/SUB_BUCKETS + 1;
+    uint64_t low = (uint64_t)(SUB_BUCKETS + (bucket - 2*SUB_BUCKETS)%SUB_BUCKETS) << shift;
+    return (double)low + ((1ull << shift) - 1)/2.0;
+}
+
+void ResetFrameHistogram(FrameHistogram *histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void AddFrameTime(FrameHistogram *histogram, uint64_t nanoseconds) {
+    histogram->counts[GetHistogramBucket(nanoseconds)]++;
+    histogram->frameCount++;
+    if (nanoseconds > histogram->maxNs) histogram->maxNs = nanoseconds;
+}
+
+// Frame time in milliseconds that the given percentage of frames stayed at or under
+// (nearest rank). The maximum is exact, every other percentile is a bucket midpoint.
+double GetFrameTimePercentile(const FrameHistogram *histogram, double percentile) {
+    if (histogram->frameCount == 0) return 0.0;
+    if (percentile >= 100.0) return histogram->maxNs/1e6;
+
+    uint64_t rank = (uint64_t)(percentile/100.0*histogram->frameCount + 0.999999);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            double value = GetHistogramBucketValue(i)/1e6;
+            return (value < histogram->maxNs/1e6) ? value : histogram->maxNs/1e6;
+        }
+    }
+    return histogram->maxNs/1e6;
+}
+
+//------------------------------------------------------------------------------------
+// Process Memory
+//------------------------------------------------------------------------------------
+// Resident set size of this process in KB, -1 where the platform is not supported
+long GetResidentMemoryKB(void) {
+#if defined(_WIN32)
+    ProcessMemoryCounters counters = { 0 };
+    counters.cb = sizeof(counters);
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return (long)(counters.workingSetSize/1024);
+#elif defined(__linux__)
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file == NULL) return -1;
+    long totalPages = 0, residentPages = 0;
+    int fields = fscanf(file, "%ld %ld", &totalPages, &residentPages);
+    fclose(file);
+    if (fields != 2) return -1;
+    return residentPages*(sysconf(_SC_PAGESIZE)/1024);
+#else
+    return -1;
+#endif
+}
+
+//------------------------------------------------------------------------------------
+// Soak Test
+//------------------------------------------------------------------------------------
+static void PrintSoakProgress(SoakTest *soak, uint64_t now, long rss) {
+    printf("[%6.0f s] %8llu frames  p50 %8.4f ms  p99 %8.4f ms  max %8.4f ms  over budget %llu  rss %ld KB\n",
+           (now - soak->startTime)/1e9, (unsigned long long)soak->window.frameCount,
+           GetFrameTimePercentile(&soak->window, 50.0), GetFrameTimePercentile(&soak->window, 99.0),
+           GetFrameTimePercentile(&soak->window, 100.0), (unsigned long long)soak->windowOverBudget, rss);
+    fflush(stdout);
+
+    ResetFrameHistogram(&soak->window);
+    soak->windowOverBudget = 0;
+    soak->lastReportTime = now;
+}
+
+void BeginSoakTest(SoakTest *soak, double durationSeconds, double budgetSeconds) {
+    memset(soak, 0, sizeof(*soak));
+    soak->durationNs = (uint64_t)(durationSeconds*1e9);
+    soak->budgetNs = (uint64_t)(budgetSeconds*1e9);
+    soak->startTime = GetClockNanoseconds();
+    soak->lastFrameTime = soak->startTime;
+    soak->lastReportTime = soak->startTime;
+    soak->startRssKB = GetResidentMemoryKB();
+    soak->peakRssKB = soak->startRssKB;
+
+    printf("Soak test: %.0f s, frame budget %.3f ms, rss %ld KB\n", durationSeconds, budgetSeconds*1000.0, soak->startRssKB);
+}
+
+// Record the time since the previous call as one frame, call once per frame.
+// Returns false once the test has run for its full duration.
+bool UpdateSoakTest(SoakTest *soak) {
+    uint64_t now = GetClockNanoseconds();
+    uint64_t frameTime = now - soak->lastFrameTime;
+    soak->lastFrameTime = now;
+
+    AddFrameTime(&soak->total, frameTime);
+    AddFrameTime(&soak->window, frameTime);
+    if (frameTime > soak->budgetNs) {
+        soak->overBudgetCount++;
+        soak->windowOverBudget++;
+    }
+
+    if (now - soak->lastReportTime >= (uint64_t)(SOAK_REPORT_INTERVAL*1e9)) {
+        long rss = GetResidentMemoryKB();
+        if (rss > soak->peakRssKB) soak->peakRssKB = rss;
+        PrintSoakProgress(soak, now, rss);
+    }
+
+    return (now - soak->startTime) < soak->durationNs;
+}
+
+void PrintSoakReport(const SoakTest *soak) {
+    const FrameHistogram *total = &soak->total;
+    long endRss = GetResidentMemoryKB();
+    long peakRss = (endRss > soak->peakRssKB) ? endRss : soak->peakRssKB;
+
+    printf("\nSoak test finished after %.1f s, %llu frames\n",
+           (soak->lastFrameTime - soak->startTime)/1e9, (unsigned long long)total->frameCount);
+    printf("  frame time  p50 %.4f ms  p90 %.4f ms  p99 %.4f ms  max %.4f ms\n",
+           GetFrameTimePercentile(total, 50.0), GetFrameTimePercentile(total, 90.0),
+           GetFrameTimePercentile(total, 99.0), GetFrameTimePercentile(total, 100.0));
+    printf("  over budget (%.3f ms)  %llu frames (%.3f%%)\n", soak->budgetNs/1e6,
+           (unsigned long long)soak->overBudgetCount,
+           (total->frameCount > 0) ? 100.0*soak->overBudgetCount/total->frameCount : 0.0);
+    if (soak->startRssKB >= 0 && endRss >= 0) {
+        printf("  rss  start %ld KB  end %ld KB  peak %ld KB  growth %+ld KB\n",
+               soak->startRssKB, endRss, peakRss, endRss - soak->startRssKB);
+    } else {
+        printf("  rss  not available on this platform\n");
+    }
+}
+
+// Soak the headless simulation: every frame runs the steps of one 60 Hz frame with
+// the bot playing, going through the levels in turn as games end
+void RunHeadlessSoak(SoakTest *soak, GameState *state, BotPlayer *bot) {
+    int level = 0;
+    do {
+        if (!state->gameStarted) {
+            level = level%3 + 1;
+            StartGame(state, level);
+        }
+
+        for (int step = 0; step < SOAK_HEADLESS_FRAME_STEPS && state->gameStarted; step++) {
+            GameInput input = UpdateBotPlayer(bot, state, SIM_FIXED_DT);
+            StepGame(state, &input, SIM_FIXED_DT);
+        }
+    } while (UpdateSoakTest(soak));
+}
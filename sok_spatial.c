@@ -0,0 +1,192 @@
+#include "sok_core.h"
+#include <math.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------------
+// Spatial Grid
+//------------------------------------------------------------------------------------
+#define GRID_WIDTH ((float)(SPATIAL_GRID_COLS * SPATIAL_CELL_SIZE))
+#define GRID_HEIGHT ((float)(SPATIAL_GRID_ROWS * SPATIAL_CELL_SIZE))
+
+static int ClampCell(int cell, int count) {
+    if (cell < 0) return 0;
+    if (cell > count - 1) return count - 1;
+    return cell;
+}
+
+// Cells overlapped by a half-open rectangle, false when it lies outside the grid
+static bool GetCellRange(Rectangle rect, int *minCol, int *minRow, int *maxCol, int *maxRow) {
+    if (rect.x + rect.width <= 0.0f || rect.y + rect.height <= 0.0f ||
+        rect.x >= GRID_WIDTH || rect.y >= GRID_HEIGHT) {
+        return false;
+    }
+
+    int col = (int)floorf(rect.x / SPATIAL_CELL_SIZE);
+    int row = (int)floorf(rect.y / SPATIAL_CELL_SIZE);
+
+    // Items are never larger than a cell, so they span at most two cells per axis
+    *minCol = ClampCell(col, SPATIAL_GRID_COLS);
+    *minRow = ClampCell(row, SPATIAL_GRID_ROWS);
+    *maxCol = ClampCell(col + 1, SPATIAL_GRID_COLS);
+    *maxRow = ClampCell(row + 1, SPATIAL_GRID_ROWS);
+    if (rect.x + rect.width <= (col + 1) * (float)SPATIAL_CELL_SIZE) *maxCol = *minCol;
+    if (rect.y + rect.height <= (row + 1) * (float)SPATIAL_CELL_SIZE) *maxRow = *minRow;
+
+    return true;
+}
+
+static bool IsPointInRect(Rectangle rect, Vector2 point) {
+    return (point.x >= rect.x) && (point.x < rect.x + rect.width) &&
+           (point.y >= rect.y) && (point.y < rect.y + rect.height);
+}
+
+// Slab test: does the segment start + t*(end - start), t in [0, 1], touch the rectangle?
+static bool SegmentOverlapsRect(Vector2 start, Vector2 end, Rectangle rect) {
+    float tMin = 0.0f;
+    float tMax = 1.0f;
+    float origin[2] = { start.x, start.y };
+    float delta[2] = { end.x - start.x, end.y - start.y };
+    float lo[2] = { rect.x, rect.y };
+    float hi[2] = { rect.x + rect.width, rect.y + rect.height };
+
+    for (int axis = 0; axis < 2; axis++) {
+        if (delta[axis] == 0.0f) {
+            if (origin[axis] < lo[axis] || origin[axis] > hi[axis]) return false;
+        } else {
+            float t0 = (lo[axis] - origin[axis]) / delta[axis];
+            float t1 = (hi[axis] - origin[axis]) / delta[axis];
+            if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+            if (t0 > tMin) tMin = t0;
+            if (t1 < tMax) tMax = t1;
+            if (tMin > tMax) return false;
+        }
+    }
+
+    return true;
+}
+
+static void LinkItem(SpatialGrid *grid, int id) {
+    int node = id * SPATIAL_CELLS_PER_ITEM;
+    for (int row = grid->minRow[id]; row <= grid->maxRow[id]; row++) {
+        for (int col = grid->minCol[id]; col <= grid->maxCol[id]; col++, node++) {
+            int cell = row * SPATIAL_GRID_COLS + col;
+            grid->nodePrev[node] = -1;
+            grid->nodeNext[node] = grid->cellHead[cell];
+            if (grid->cellHead[cell] != -1) grid->nodePrev[grid->cellHead[cell]] = node;
+            grid->cellHead[cell] = node;
+        }
+    }
+}
+
+static void UnlinkItem(SpatialGrid *grid, int id) {
+    int node = id * SPATIAL_CELLS_PER_ITEM;
+    for (int row = grid->minRow[id]; row <= grid->maxRow[id]; row++) {
+        for (int col = grid->minCol[id]; col <= grid->maxCol[id]; col++, node++) {
+            int cell = row * SPATIAL_GRID_COLS + col;
+            int prev = grid->nodePrev[node];
+            int next = grid->nodeNext[node];
+            if (prev != -1) grid->nodeNext[prev] = next;
+            else grid->cellHead[cell] = next;
+            if (next != -1) grid->nodePrev[next] = prev;
+        }
+    }
+    grid->minCol[id] = -1;
+}
+
+void InitSpatialGrid(SpatialGrid *grid) {
+    for (int i = 0; i < SPATIAL_GRID_COLS * SPATIAL_GRID_ROWS; i++) {
+        grid->cellHead[i] = -1;
+    }
+    for (int i = 0; i < MAX_DRONES; i++) {
+        grid->minCol[i] = -1;
+        grid->visitStamp[i] = 0;
+    }
+    grid->queryStamp = 0;
+}
+
+// Insert or move an item. Cheap when the item stays within the same cells.
+void UpdateSpatialItem(SpatialGrid *grid, int id, Rectangle rect) {
+    int minCol, minRow, maxCol, maxRow;
+    bool inside = GetCellRange(rect, &minCol, &minRow, &maxCol, &maxRow);
+
+    grid->rect[id] = rect;
+
+    if (grid->minCol[id] != -1) {
+        if (inside && grid->minCol[id] == minCol && grid->minRow[id] == minRow &&
+            grid->maxCol[id] == maxCol && grid->maxRow[id] == maxRow) {
+            return;
+        }
+        UnlinkItem(grid, id);
+    }
+
+    if (inside) {
+        grid->minCol[id] = (signed char)minCol;
+        grid->minRow[id] = (signed char)minRow;
+        grid->maxCol[id] = (signed char)maxCol;
+        grid->maxRow[id] = (signed char)maxRow;
+        LinkItem(grid, id);
+    }
+}
+
+void RemoveSpatialItem(SpatialGrid *grid, int id) {
+    if (grid->minCol[id] != -1) UnlinkItem(grid, id);
+}
+
+// Items whose rectangle contains the point, returns how many were written to results
+int QuerySpatialPoint(const SpatialGrid *grid, Vector2 point, int *results, int maxResults) {
+    if (point.x < 0.0f || point.y < 0.0f || point.x >= GRID_WIDTH || point.y >= GRID_HEIGHT) return 0;
+
+    int cell = (int)(point.y / SPATIAL_CELL_SIZE) * SPATIAL_GRID_COLS + (int)(point.x / SPATIAL_CELL_SIZE);
+    int found = 0;
+
+    for (int node = grid->cellHead[cell]; node != -1 && found < maxResults; node = grid->nodeNext[node]) {
+        int id = node / SPATIAL_CELLS_PER_ITEM;
+        if (IsPointInRect(grid->rect[id], point)) {
+            results[found++] = id;
+        }
+    }
+
+    return found;
+}
+
+// Items whose rectangle the segment touches, returns how many were written to results
+int QuerySpatialSegment(SpatialGrid *grid, Vector2 start, Vector2 end, int *results, int maxResults) {
+    Rectangle bounds = {
+        fminf(start.x, end.x), fminf(start.y, end.y),
+        fabsf(end.x - start.x), fabsf(end.y - start.y)
+    };
+    if (bounds.x + bounds.width < 0.0f || bounds.y + bounds.height < 0.0f ||
+        bounds.x >= GRID_WIDTH || bounds.y >= GRID_HEIGHT) {
+        return 0;
+    }
+
+    int minCol = ClampCell((int)floorf(bounds.x / SPATIAL_CELL_SIZE), SPATIAL_GRID_COLS);
+    int minRow = ClampCell((int)floorf(bounds.y / SPATIAL_CELL_SIZE), SPATIAL_GRID_ROWS);
+    int maxCol = ClampCell((int)floorf((bounds.x + bounds.width) / SPATIAL_CELL_SIZE), SPATIAL_GRID_COLS);
+    int maxRow = ClampCell((int)floorf((bounds.y + bounds.height) / SPATIAL_CELL_SIZE), SPATIAL_GRID_ROWS);
+
+    // New stamp so items spanning several cells are only tested once
+    if (++grid->queryStamp == 0) {
+        memset(grid->visitStamp, 0, sizeof(grid->visitStamp));
+        grid->queryStamp = 1;
+    }
+
+    int found = 0;
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int col = minCol; col <= maxCol; col++) {
+            int cell = row * SPATIAL_GRID_COLS + col;
+            for (int node = grid->cellHead[cell]; node != -1; node = grid->nodeNext[node]) {
+                int id = node / SPATIAL_CELLS_PER_ITEM;
+                if (grid->visitStamp[id] == grid->queryStamp) continue;
+                grid->visitStamp[id] = grid->queryStamp;
+
+                if (SegmentOverlapsRect(start, end, grid->rect[id])) {
+                    if (found == maxResults) return found;
+                    results[found++] = id;
+                }
+            }
+        }
+    }
+
+    return found;
+}
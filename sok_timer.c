@@ -0,0 +1,113 @@
+#include "sok_core.h"
+#include <math.h>
+
+//------------------------------------------------------------------------------------
+// Timing Wheel
+//------------------------------------------------------------------------------------
+#define EXPIRED_BUCKET (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+static void LinkTimer(TimerWheel *wheel, int id, int bucket) {
+    wheel->bucket[id] = (short)bucket;
+    wheel->prev[id] = -1;
+    wheel->next[id] = wheel->bucketHead[bucket];
+    if (wheel->bucketHead[bucket] != -1) wheel->prev[wheel->bucketHead[bucket]] = id;
+    wheel->bucketHead[bucket] = id;
+}
+
+static void UnlinkTimer(TimerWheel *wheel, int id) {
+    int prev = wheel->prev[id];
+    int next = wheel->next[id];
+    if (prev != -1) wheel->next[prev] = next;
+    else wheel->bucketHead[wheel->bucket[id]] = next;
+    if (next != -1) wheel->prev[next] = prev;
+    wheel->bucket[id] = -1;
+}
+
+// Lowest level whose slot still lies ahead of the current tick: the first level at
+// which the expiry and the current tick agree on every higher bit
+static int GetTimerBucket(const TimerWheel *wheel, unsigned int expires) {
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           ((expires ^ wheel->tick) >> ((level + 1) * TIMER_WHEEL_BITS)) != 0) {
+        level++;
+    }
+    return level * TIMER_WHEEL_SLOTS + ((expires >> (level * TIMER_WHEEL_BITS)) & SLOT_MASK);
+}
+
+// Re-file every timer of a higher-level slot now that time has reached it
+static void CascadeTimers(TimerWheel *wheel, int bucket) {
+    int id = wheel->bucketHead[bucket];
+    wheel->bucketHead[bucket] = -1;
+    while (id != -1) {
+        int next = wheel->next[id];
+        LinkTimer(wheel, id, GetTimerBucket(wheel, wheel->expires[id]));
+        id = next;
+    }
+}
+
+void InitTimerWheel(TimerWheel *wheel) {
+    wheel->tick = 0;
+    wheel->tickFraction = 0.0f;
+    for (int i = 0; i <= EXPIRED_BUCKET; i++) {
+        wheel->bucketHead[i] = -1;
+    }
+    for (int i = 0; i < MAX_DRONES; i++) {
+        wheel->bucket[i] = -1;
+    }
+}
+
+// Fire a timer on the first tick after 'delay' seconds, replacing any pending one.
+// Delays beyond TIMER_WHEEL_MAX_DELAY ticks are clamped.
+void ScheduleTimer(TimerWheel *wheel, int id, float delay) {
+    if (wheel->bucket[id] != -1) UnlinkTimer(wheel, id);
+
+    float ticks = floorf(delay * SIM_TICK_RATE) + 1.0f;
+    unsigned int delayTicks = 1;
+    if (ticks >= (float)TIMER_WHEEL_MAX_DELAY) delayTicks = TIMER_WHEEL_MAX_DELAY;
+    else if (ticks > 1.0f) delayTicks = (unsigned int)ticks;
+
+    wheel->expires[id] = wheel->tick + delayTicks;
+    LinkTimer(wheel, id, GetTimerBucket(wheel, wheel->expires[id]));
+}
+
+void CancelTimer(TimerWheel *wheel, int id) {
+    if (wheel->bucket[id] != -1) UnlinkTimer(wheel, id);
+}
+
+// Advance by whole ticks, moving timers that come due onto the expired list
+void AdvanceTimerWheel(TimerWheel *wheel, float deltaTime) {
+    // Small bias so a step of exactly SIM_FIXED_DT always counts as one tick
+    wheel->tickFraction += deltaTime * SIM_TICK_RATE;
+    int ticks = (int)(wheel->tickFraction + 1e-3f);
+    wheel->tickFraction -= (float)ticks;
+
+    for (int i = 0; i < ticks; i++) {
+        wheel->tick++;
+
+        // Entering a new turn of a level pulls its next slot down, highest level first
+        for (int level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+            if ((wheel->tick & ((1u << (level * TIMER_WHEEL_BITS)) - 1)) == 0) {
+                int slot = (wheel->tick >> (level * TIMER_WHEEL_BITS)) & SLOT_MASK;
+                CascadeTimers(wheel, level * TIMER_WHEEL_SLOTS + slot);
+            }
+        }
+
+        // Everything in the current level-0 slot expires on this tick
+        int bucket = wheel->tick & SLOT_MASK;
+        int id = wheel->bucketHead[bucket];
+        wheel->bucketHead[bucket] = -1;
+        while (id != -1) {
+            int next = wheel->next[id];
+            LinkTimer(wheel, id, EXPIRED_BUCKET);
+            id = next;
+        }
+    }
+}
+
+// Next expired timer id (its timer is consumed), -1 when none is left
+int PopExpiredTimer(TimerWheel *wheel) {
+    int id = wheel->bucketHead[EXPIRED_BUCKET];
+    if (id != -1) UnlinkTimer(wheel, id);
+    return id;
+}
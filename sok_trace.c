@@ -0,0 +1,97 @@
+#include "sok_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------------
+// Trace Capture
+//------------------------------------------------------------------------------------
+// Completed zones are buffered in memory while a capture runs and only written out
+// when it ends, so recording a zone never touches the disk.
+// NOTE: Not thread-safe, zones are only recorded while the main thread runs a capture
+#define TRACE_EVENT_CHUNK 4096
+
+typedef struct TraceEvent {
+    const char *name;
+    uint64_t start;         // Nanoseconds since the capture began
+    uint64_t duration;
+} TraceEvent;
+
+static struct {
+    bool capturing;
+    uint64_t captureStart;
+    TraceEvent *events;
+    int count;
+    int capacity;
+    int droppedCount;       // Zones lost because the buffer reached TRACE_MAX_EVENTS
+} trace = { 0 };
+
+void BeginTraceCapture(void) {
+    trace.count = 0;
+    trace.droppedCount = 0;
+    trace.captureStart = GetClockNanoseconds();
+    trace.capturing = true;
+}
+
+bool IsTraceCapturing(void) {
+    return trace.capturing;
+}
+
+// Stop the capture and write it as Chrome trace-event JSON (chrome://tracing,
+// ui.perfetto.dev). Returns false if nothing was capturing or the file can't be written.
+bool EndTraceCapture(const char *fileName) {
+    if (!trace.capturing) return false;
+    trace.capturing = false;
+
+    FILE *file = fopen(fileName, "w");
+    bool written = (file != NULL);
+    if (written) {
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"sky_over_kharkov\"}}");
+        for (int i = 0; i < trace.count; i++) {
+            const TraceEvent *event = &trace.events[i];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+                    event->name, event->start / 1000.0, event->duration / 1000.0);
+        }
+        fprintf(file, "\n]}\n");
+        written = (fclose(file) == 0);
+    }
+
+    if (trace.droppedCount > 0) {
+        printf("Trace buffer full, %d zones were not recorded\n", trace.droppedCount);
+    }
+
+    free(trace.events);
+    trace.events = NULL;
+    trace.count = 0;
+    trace.capacity = 0;
+
+    return written;
+}
+
+TraceZone BeginTraceZone(const char *name) {
+    TraceZone zone = { name, 0 };
+    if (trace.capturing) zone.start = GetClockNanoseconds();
+    return zone;
+}
+
+void EndTraceZone(const TraceZone *zone) {
+    // Zones opened before the capture started are left out
+    if (!trace.capturing || zone->start < trace.captureStart) return;
+    uint64_t end = GetClockNanoseconds();
+
+    if (trace.count == trace.capacity) {
+        int capacity = trace.capacity + TRACE_EVENT_CHUNK;
+        TraceEvent *events = (capacity <= TRACE_MAX_EVENTS) ? realloc(trace.events, capacity * sizeof(TraceEvent)) : NULL;
+        if (events == NULL) {
+            trace.droppedCount++;
+            return;
+        }
+        trace.events = events;
+        trace.capacity = capacity;
+    }
+
+    TraceEvent *event = &trace.events[trace.count++];
+    event->name = zone->name;
+    event->start = zone->start - trace.captureStart;
+    event->duration = end - zone->start;
+}
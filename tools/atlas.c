@@ -0,0 +1,134 @@
+// sok_atlas: packs the sprites listed in atlas.h into one texture at build time and
+// writes the rectangle of every sprite as a C table for the game to include.
+// Run from the source directory (image paths in atlas.h are relative to it).
+//
+// Usage: sok_atlas ATLAS_PNG RECTS_HEADER
+
+#include "raylib.h"
+#include "atlas.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ATLAS_FILE_ENTRY(id, file) file,
+static const char *spriteFiles[ATLAS_SPRITE_COUNT] = { ATLAS_SPRITES(ATLAS_FILE_ENTRY) };
+#undef ATLAS_FILE_ENTRY
+
+#define ATLAS_NAME_ENTRY(id, file) #id,
+static const char *spriteNames[ATLAS_SPRITE_COUNT] = { ATLAS_SPRITES(ATLAS_NAME_ENTRY) };
+#undef ATLAS_NAME_ENTRY
+
+//------------------------------------------------------------------------------------
+// Packing
+//------------------------------------------------------------------------------------
+static Image images[ATLAS_SPRITE_COUNT];
+static Rectangle rects[ATLAS_SPRITE_COUNT];
+
+static int CompareSpriteHeights(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    if (images[x].height != images[y].height) return images[y].height - images[x].height;
+    return x - y;
+}
+
+static int NextPowerOfTwo(int value) {
+    int power = 1;
+    while (power < value) power *= 2;
+    return power;
+}
+
+// Shelf packing, tallest sprites first: fill a row left to right, then open the next
+// row below it. Returns the power of two height used, 0 if it does not fit.
+static int PackShelves(const int *order, int width) {
+    int x = 0, y = 0, shelfHeight = 0;
+    for (int i = 0; i < ATLAS_SPRITE_COUNT; i++) {
+        int w = images[order[i]].width + ATLAS_PADDING;
+        int h = images[order[i]].height + ATLAS_PADDING;
+        if (w > width) return 0;
+        if (x + w > width) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        rects[order[i]] = (Rectangle){ (float)x, (float)y, (float)images[order[i]].width, (float)images[order[i]].height };
+        x += w;
+        if (h > shelfHeight) shelfHeight = h;
+    }
+
+    int height = NextPowerOfTwo(y + shelfHeight);
+    return (height <= ATLAS_MAX_SIZE) ? height : 0;
+}
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        printf("Usage: %s ATLAS_PNG RECTS_HEADER\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 0; i < ATLAS_SPRITE_COUNT; i++) {
+        if (spriteFiles[i] == NULL) {
+            images[i] = GenImageColor(ATLAS_SOLID_SIZE, ATLAS_SOLID_SIZE, WHITE);
+        } else {
+            images[i] = LoadImage(spriteFiles[i]);
+            if (images[i].data == NULL) {
+                fprintf(stderr, "Could not load %s\n", spriteFiles[i]);
+                return 1;
+            }
+        }
+        ImageFormat(&images[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+
+    int order[ATLAS_SPRITE_COUNT];
+    for (int i = 0; i < ATLAS_SPRITE_COUNT; i++) order[i] = i;
+    qsort(order, ATLAS_SPRITE_COUNT, sizeof(int), CompareSpriteHeights);
+
+    // Smallest power of two texture the sprites fit in, the narrower one on a tie
+    int bestWidth = 0, bestHeight = 0;
+    for (int width = 64; width <= ATLAS_MAX_SIZE; width *= 2) {
+        int height = PackShelves(order, width);
+        if (height > 0 && (bestWidth == 0 || width*height < bestWidth*bestHeight)) {
+            bestWidth = width;
+            bestHeight = height;
+        }
+    }
+    if (bestWidth == 0) {
+        fprintf(stderr, "Sprites do not fit in a %dx%d atlas\n", ATLAS_MAX_SIZE, ATLAS_MAX_SIZE);
+        return 1;
+    }
+    PackShelves(order, bestWidth);
+
+    Image atlas = GenImageColor(bestWidth, bestHeight, BLANK);
+    for (int i = 0; i < ATLAS_SPRITE_COUNT; i++) {
+        ImageDraw(&atlas, images[i], (Rectangle){ 0, 0, (float)images[i].width, (float)images[i].height }, rects[i], WHITE);
+        UnloadImage(images[i]);
+    }
+
+    bool exported = ExportImage(atlas, argv[1]);
+    UnloadImage(atlas);
+    if (!exported) {
+        fprintf(stderr, "Could not write %s\n", argv[1]);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[2], "w");
+    if (file == NULL) {
+        fprintf(stderr, "Could not write %s\n", argv[2]);
+        return 1;
+    }
+    fprintf(file, "// Generated by sok_atlas from the sprites listed in atlas.h, do not edit\n");
+    fprintf(file, "#ifndef ATLAS_RECTS_H\n#define ATLAS_RECTS_H\n\n");
+    fprintf(file, "#define ATLAS_WIDTH %d\n#define ATLAS_HEIGHT %d\n\n", bestWidth, bestHeight);
+    fprintf(file, "static const Rectangle atlasRects[ATLAS_SPRITE_COUNT] = {\n");
+    for (int i = 0; i < ATLAS_SPRITE_COUNT; i++) {
+        fprintf(file, "    { %4.0f, %4.0f, %4.0f, %4.0f },    // %s\n", rects[i].x, rects[i].y, rects[i].width, rects[i].height, spriteNames[i]);
+    }
+    fprintf(file, "};\n\n#endif // ATLAS_RECTS_H\n");
+    fclose(file);
+
+    printf("Packed %d sprites into a %dx%d atlas\n", ATLAS_SPRITE_COUNT, bestWidth, bestHeight);
+
+    return 0;
+}
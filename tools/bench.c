@@ -0,0 +1,274 @@
+// sok_bench: times the simulation's hot functions in isolation. Every sample restores
+// the same starting state outside the timed region, runs the function under test a
+// fixed number of times and records the time per call; after the warmup samples the
+// median, p99, mean and minimum are reported as a table or as JSON.
+//
+// Usage: sok_bench [--drones N] [--projectiles N] [--warmup N] [--reps N]
+//                  [--seed N] [--filter NAME] [--json [FILE]]
+
+#include "sok_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------------
+// Benchmark Context
+//------------------------------------------------------------------------------------
+typedef struct BenchContext {
+    int droneCount;
+    int projectileCount;
+    RandomStream random;
+
+    DronePool *templateDrones;      // Starting drone pool, restored before every sample
+    DronePool *drones;
+    ProjectilePool projectiles;
+    GameRules rules;
+    MathEquation equation;
+    int ammo;
+    int score;
+    bool shahedActive;
+    int activeDroneCount;
+    DroneStatus status;             // Sink so CheckDroneStatus isn't optimized away
+} BenchContext;
+
+typedef struct Benchmark {
+    const char *name;
+    int callsPerSample;
+    void (*setup)(BenchContext *ctx);   // Untimed, before every sample
+    void (*run)(BenchContext *ctx);     // One call of the function under test
+} Benchmark;
+
+// Spread the drones over the visible field, one of them the Shahed and every eighth one
+// mid-explosion so the state timers have work to do. Answers stay within the range the
+// answer index covers, as in play, so lookups take the bitset path.
+static void BuildTemplateDrones(BenchContext *ctx) {
+    ClearDrones(ctx->templateDrones);
+    for (int i = 0; i < ctx->droneCount; i++) {
+        Vector2 position = {
+            (float)(DRONE_LEFT_BOUNDARY + 50 + GetRandomBelow(&ctx->random, SCREEN_WIDTH - 200)),
+            (float)(DRONE_SPAWN_Y_MIN + GetRandomBelow(&ctx->random, (int)DRONE_SPAWN_Y_RANGE))
+        };
+        int index = AddDrone(ctx->templateDrones, position, i % 512, (i == 0));
+        if (index >= 0 && i % 8 == 7) SetDroneState(ctx->templateDrones, index, DRONE_EXPLODING);
+    }
+}
+
+static void RestoreDrones(BenchContext *ctx) {
+    memcpy(ctx->drones, ctx->templateDrones, sizeof(DronePool));
+}
+
+//------------------------------------------------------------------------------------
+// Benchmarks
+//------------------------------------------------------------------------------------
+static void SetupNothing(BenchContext *ctx) {
+    (void)ctx;
+}
+
+static void RunGenerateNewEquation(BenchContext *ctx) {
+    GenerateNewEquation(&ctx->equation, 3, ctx->drones, false, &ctx->random);
+}
+
+static void RunCreateDecomposedEquation(BenchContext *ctx) {
+    CreateDecomposedEquation(&ctx->equation);
+}
+
+static void SetupSpawnDrones(BenchContext *ctx) {
+    ClearDrones(ctx->drones);
+}
+
+static void RunSpawnDrones(BenchContext *ctx) {
+    SpawnDrones(ctx->drones, &ctx->equation, ctx->droneCount, DISTRACTORS_NEARBY, &ctx->activeDroneCount, &ctx->random, &ctx->random);
+}
+
+static void SetupUpdateDrones(BenchContext *ctx) {
+    RestoreDrones(ctx);
+}
+
+static void RunUpdateDrones(BenchContext *ctx) {
+    UpdateDrones(ctx->drones, SIM_FIXED_DT);
+}
+
+// Tracers fired from the ground at random drones, as after a burst of shots
+static void SetupUpdateProjectiles(BenchContext *ctx) {
+    RestoreDrones(ctx);
+    ClearProjectiles(&ctx->projectiles);
+    for (int i = 0; i < ctx->projectileCount; i++) {
+        Vector2 start = { (float)GetRandomBelow(&ctx->random, SCREEN_WIDTH), (float)SCREEN_HEIGHT - 60.0f };
+        EntityHandle target = { -1, 0 };
+        Vector2 aim = { start.x, 0.0f };
+        if (ctx->drones->flyingCount > 0) {
+            int index = GetRandomBelow(&ctx->random, ctx->drones->flyingCount);
+            target = GetDroneHandle(ctx->drones, index);
+            aim = GetDroneBounds(GetDronePosition(ctx->drones, index)).center;
+        }
+        SpawnProjectile(&ctx->projectiles, ctx->drones, start, aim, target);
+    }
+    ctx->ammo = INITIAL_AMMO;
+}
+
+static void RunUpdateProjectiles(BenchContext *ctx) {
+    UpdateProjectiles(&ctx->projectiles, ctx->drones, &ctx->rules, &ctx->ammo, &ctx->score, &ctx->shahedActive, SIM_FIXED_DT);
+}
+
+static void RunCheckDroneStatus(BenchContext *ctx) {
+    ctx->status = CheckDroneStatus(ctx->drones);
+}
+
+static const Benchmark benchmarks[] = {
+    { "GenerateNewEquation", 64, SetupNothing, RunGenerateNewEquation },
+    { "CreateDecomposedEquation", 256, SetupNothing, RunCreateDecomposedEquation },
+    { "SpawnDrones", 1, SetupSpawnDrones, RunSpawnDrones },
+    { "UpdateDrones", 1, SetupUpdateDrones, RunUpdateDrones },
+    { "UpdateProjectiles", 1, SetupUpdateProjectiles, RunUpdateProjectiles },
+    { "CheckDroneStatus", 16, SetupUpdateDrones, RunCheckDroneStatus },
+};
+
+//------------------------------------------------------------------------------------
+// Statistics
+//------------------------------------------------------------------------------------
+typedef struct BenchResult {
+    const char *name;
+    int callsPerSample;
+    double medianNs;
+    double p99Ns;
+    double meanNs;
+    double minNs;
+} BenchResult;
+
+static int CompareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double GetPercentile(const double *sorted, int count, double percentile) {
+    int rank = (int)(percentile / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static BenchResult RunBenchmark(const Benchmark *benchmark, BenchContext *ctx, int warmup, int repetitions, double *samples) {
+    for (int i = 0; i < warmup + repetitions; i++) {
+        benchmark->setup(ctx);
+
+        uint64_t start = GetClockNanoseconds();
+        for (int call = 0; call < benchmark->callsPerSample; call++) {
+            benchmark->run(ctx);
+        }
+        uint64_t end = GetClockNanoseconds();
+
+        if (i >= warmup) samples[i - warmup] = (double)(end - start) / benchmark->callsPerSample;
+    }
+
+    qsort(samples, repetitions, sizeof(double), CompareDoubles);
+
+    BenchResult result = { .name = benchmark->name, .callsPerSample = benchmark->callsPerSample };
+    double sum = 0.0;
+    for (int i = 0; i < repetitions; i++) sum += samples[i];
+    result.medianNs = GetPercentile(samples, repetitions, 50.0);
+    result.p99Ns = GetPercentile(samples, repetitions, 99.0);
+    result.meanNs = sum / repetitions;
+    result.minNs = samples[0];
+    return result;
+}
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    int droneCount = 64;
+    int projectileCount = 30;
+    int warmup = 20;
+    int repetitions = 500;
+    uint64_t seed = 1;
+    const char *filter = NULL;
+    bool json = false;
+    const char *jsonFile = NULL;    // stdout when not given
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--drones") == 0 && i + 1 < argc) {
+            droneCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--projectiles") == 0 && i + 1 < argc) {
+            projectileCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') jsonFile = argv[++i];
+        } else {
+            printf("Usage: %s [--drones N] [--projectiles N] [--warmup N] [--reps N] [--seed N] [--filter NAME] [--json [FILE]]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (droneCount < 1) droneCount = 1;
+    if (droneCount > MAX_DRONES) droneCount = MAX_DRONES;
+    if (projectileCount < 0) projectileCount = 0;
+    if (warmup < 0) warmup = 0;
+    if (repetitions < 1) repetitions = 1;
+
+    // The drone pools are too large for the stack
+    BenchContext ctx = { 0 };
+    ctx.droneCount = droneCount;
+    ctx.projectileCount = projectileCount;
+    ctx.rules = (GameRules){ INITIAL_AMMO, SHOT_COST, HIT_REWARD, MAX_AMMO };
+    ctx.templateDrones = malloc(sizeof(DronePool));
+    ctx.drones = malloc(sizeof(DronePool));
+    double *samples = malloc(repetitions * sizeof(double));
+    if (ctx.templateDrones == NULL || ctx.drones == NULL || samples == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    SeedRandomStream(&ctx.random, seed, 0);
+    BuildTemplateDrones(&ctx);
+    RestoreDrones(&ctx);
+    GenerateNewEquation(&ctx.equation, 3, ctx.drones, false, &ctx.random);
+
+    const int benchmarkCount = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    BenchResult results[sizeof(benchmarks) / sizeof(benchmarks[0])];
+    int resultCount = 0;
+    for (int i = 0; i < benchmarkCount; i++) {
+        if (filter != NULL && strstr(benchmarks[i].name, filter) == NULL) continue;
+        results[resultCount++] = RunBenchmark(&benchmarks[i], &ctx, warmup, repetitions, samples);
+    }
+
+    if (json) {
+        FILE *out = (jsonFile != NULL) ? fopen(jsonFile, "w") : stdout;
+        if (out == NULL) {
+            fprintf(stderr, "Could not write %s\n", jsonFile);
+            return 1;
+        }
+        fprintf(out, "{\n  \"drones\": %d,\n  \"projectiles\": %d,\n  \"warmup\": %d,\n  \"repetitions\": %d,\n  \"seed\": %llu,\n  \"results\": [\n",
+                droneCount, projectileCount, warmup, repetitions, (unsigned long long)seed);
+        for (int i = 0; i < resultCount; i++) {
+            fprintf(out, "    { \"name\": \"%s\", \"calls_per_sample\": %d, \"median_ns\": %.1f, \"p99_ns\": %.1f, \"mean_ns\": %.1f, \"min_ns\": %.1f }%s\n",
+                    results[i].name, results[i].callsPerSample, results[i].medianNs, results[i].p99Ns,
+                    results[i].meanNs, results[i].minNs, (i + 1 < resultCount) ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+        if (out != stdout) fclose(out);
+    } else {
+        printf("%d drones, %d projectiles, %d samples after %d warmup\n\n", droneCount, projectileCount, repetitions, warmup);
+        printf("%-26s %12s %12s %12s %12s\n", "function", "median ns", "p99 ns", "mean ns", "min ns");
+        for (int i = 0; i < resultCount; i++) {
+            printf("%-26s %12.1f %12.1f %12.1f %12.1f\n", results[i].name, results[i].medianNs,
+                   results[i].p99Ns, results[i].meanNs, results[i].minNs);
+        }
+    }
+
+    UnloadProjectiles(&ctx.projectiles);
+    free(ctx.templateDrones);
+    free(ctx.drones);
+    free(samples);
+
+    return 0;
+}
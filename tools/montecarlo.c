@@ -0,0 +1,300 @@
+// sok_montecarlo: plays many headless games with the bot player on every CPU core to
+// balance the ammo economy. Every combination of the swept rules, the levels and the
+// allowNegativeResults setting is one configuration; for each the tool reports the
+// game-over rate, mean survival time, score and the mean ammo curve.
+//
+// A game is over once the player is out of ammo: below the shot cost with no tracer
+// still in flight. The game itself keeps spawning waves at that point, so survivors
+// are cut off after --duration seconds of game time.
+//
+// Workers take every threads-th game of each configuration and own their game state
+// and results, nothing mutable is shared. Game seeds depend only on the base seed and
+// the game's configuration and number, so the totals don't depend on the thread count.
+//
+// Usage: sok_montecarlo [--games N] [--duration SECONDS] [--accuracy A] [--reaction SECONDS]
+//                       [--shot-cost LIST] [--hit-reward LIST] [--initial-ammo LIST]
+//                       [--levels LIST] [--threads N] [--seed N] [--csv FILE]
+//        LIST is comma separated, e.g. --shot-cost 1,2,3
+
+#define _POSIX_C_SOURCE 200112L     // sysconf() under -std=c99
+
+#include "sok_core.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_SWEEP_VALUES 16
+#define MAX_CONFIGS 4096
+#define MAX_THREADS 256
+#define AMMO_CURVE_POINTS 30        // Ammo samples per game, evenly spread over the duration
+
+//------------------------------------------------------------------------------------
+// Types and Structures Definition
+//------------------------------------------------------------------------------------
+typedef struct SimConfig {
+    GameRules rules;
+    int level;
+    bool allowNegativeResults;
+} SimConfig;
+
+typedef struct SimResult {
+    long long games;
+    long long gameOvers;
+    double survivalSum;             // Seconds, survivors count with the full duration
+    double scoreSum;
+    double ammoSum[AMMO_CURVE_POINTS];
+} SimResult;
+
+typedef struct SimSettings {
+    const SimConfig *configs;
+    int configCount;
+    int gamesPerConfig;
+    float duration;
+    float accuracy;
+    float reaction;
+    uint64_t seed;
+    int threadCount;
+} SimSettings;
+
+typedef struct SimWorker {
+    const SimSettings *settings;
+    int index;
+    SimResult *results;             // One per configuration, owned by this worker
+} SimWorker;
+
+//------------------------------------------------------------------------------------
+// Simulation
+//------------------------------------------------------------------------------------
+static uint64_t GetGameSeed(uint64_t seed, int config, int game) {
+    return seed*0x9E3779B97F4A7C15ull ^ ((uint64_t)config << 32) ^ (uint64_t)game;
+}
+
+static void PlayGame(GameState *state, const SimSettings *settings, const SimConfig *config, uint64_t seed, SimResult *result) {
+    InitGameState(state, seed);
+    state->rules = config->rules;
+    state->ammo = config->rules.initialAmmo;
+    state->allowNegativeResults = config->allowNegativeResults;
+
+    BotPlayer bot;
+    InitBotPlayer(&bot, settings->accuracy, settings->reaction, seed);
+    StartGame(state, config->level);
+
+    int totalSteps = (int)(settings->duration*SIM_TICK_RATE);
+    int sample = 0;
+    float survival = settings->duration;
+    bool gameOver = false;
+
+    for (int step = 1; step <= totalSteps; step++) {
+        GameInput input = UpdateBotPlayer(&bot, state, SIM_FIXED_DT);
+        input.restartPressed = false;
+        StepGame(state, &input, SIM_FIXED_DT);
+
+        if (state->ammo < state->rules.shotCost && state->projectiles.count == 0) {
+            gameOver = true;
+            survival = step*SIM_FIXED_DT;
+            break;
+        }
+
+        // Sample k is taken at the end of the (k + 1)-th slice of the duration
+        while (sample < AMMO_CURVE_POINTS && (long long)step*AMMO_CURVE_POINTS >= (long long)totalSteps*(sample + 1)) {
+            result->ammoSum[sample++] += state->ammo;
+        }
+    }
+
+    // Out of ammo, it stays where it is for the rest of the curve
+    while (sample < AMMO_CURVE_POINTS) result->ammoSum[sample++] += state->ammo;
+
+    result->games++;
+    if (gameOver) result->gameOvers++;
+    result->survivalSum += survival;
+    result->scoreSum += state->score;
+
+    UnloadGameState(state);
+}
+
+static void *RunWorker(void *data) {
+    SimWorker *worker = (SimWorker *)data;
+    const SimSettings *settings = worker->settings;
+
+    // Too large for a thread's stack with the full drone pool
+    GameState *state = calloc(1, sizeof(GameState));
+    if (state == NULL) return NULL;
+
+    for (int config = 0; config < settings->configCount; config++) {
+        for (int game = worker->index; game < settings->gamesPerConfig; game += settings->threadCount) {
+            PlayGame(state, settings, &settings->configs[config], GetGameSeed(settings->seed, config, game), &worker->results[config]);
+        }
+    }
+
+    free(state);
+    return NULL;
+}
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+static int ParseIntList(const char *text, int *values, int maxValues) {
+    int count = 0;
+    while (*text != '\0' && count < maxValues) {
+        char *end;
+        values[count++] = (int)strtol(text, &end, 10);
+        if (end == text) return 0;
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    SimSettings settings = { 0 };
+    settings.gamesPerConfig = 10000;
+    settings.duration = 300.0f;
+    settings.accuracy = BOT_DEFAULT_ACCURACY;
+    settings.reaction = BOT_DEFAULT_REACTION_TIME;
+    settings.seed = 1;
+    settings.threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *csvFile = NULL;
+
+    int shotCosts[MAX_SWEEP_VALUES] = { SHOT_COST };
+    int hitRewards[MAX_SWEEP_VALUES] = { HIT_REWARD };
+    int initialAmmos[MAX_SWEEP_VALUES] = { INITIAL_AMMO };
+    int levels[MAX_SWEEP_VALUES] = { 1, 2, 3 };
+    int shotCostCount = 1, hitRewardCount = 1, initialAmmoCount = 1, levelCount = 3;
+
+    for (int i = 1; i < argc; i++) {
+        bool valid = true;
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            settings.gamesPerConfig = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            settings.duration = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--accuracy") == 0 && i + 1 < argc) {
+            settings.accuracy = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--reaction") == 0 && i + 1 < argc) {
+            settings.reaction = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--shot-cost") == 0 && i + 1 < argc) {
+            valid = (shotCostCount = ParseIntList(argv[++i], shotCosts, MAX_SWEEP_VALUES)) > 0;
+        } else if (strcmp(argv[i], "--hit-reward") == 0 && i + 1 < argc) {
+            valid = (hitRewardCount = ParseIntList(argv[++i], hitRewards, MAX_SWEEP_VALUES)) > 0;
+        } else if (strcmp(argv[i], "--initial-ammo") == 0 && i + 1 < argc) {
+            valid = (initialAmmoCount = ParseIntList(argv[++i], initialAmmos, MAX_SWEEP_VALUES)) > 0;
+        } else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            valid = (levelCount = ParseIntList(argv[++i], levels, MAX_SWEEP_VALUES)) > 0;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            settings.threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            settings.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvFile = argv[++i];
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            printf("Usage: %s [--games N] [--duration SECONDS] [--accuracy A] [--reaction SECONDS]\n"
+                   "       [--shot-cost LIST] [--hit-reward LIST] [--initial-ammo LIST] [--levels LIST]\n"
+                   "       [--threads N] [--seed N] [--csv FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (settings.gamesPerConfig < 1) settings.gamesPerConfig = 1;
+    if (settings.duration < SIM_FIXED_DT) settings.duration = SIM_FIXED_DT;
+    if (settings.threadCount < 1) settings.threadCount = 1;
+    if (settings.threadCount > MAX_THREADS) settings.threadCount = MAX_THREADS;
+    if (settings.threadCount > settings.gamesPerConfig) settings.threadCount = settings.gamesPerConfig;
+
+    // Every combination of swept rules, level and allowNegativeResults
+    static SimConfig configs[MAX_CONFIGS];
+    int configCount = 0;
+    for (int c = 0; c < shotCostCount; c++)
+        for (int r = 0; r < hitRewardCount; r++)
+            for (int a = 0; a < initialAmmoCount; a++)
+                for (int l = 0; l < levelCount; l++)
+                    for (int negative = 0; negative <= 1 && configCount < MAX_CONFIGS; negative++) {
+                        SimConfig *config = &configs[configCount++];
+                        config->rules = (GameRules){ initialAmmos[a], shotCosts[c], hitRewards[r], MAX_AMMO };
+                        config->level = levels[l];
+                        config->allowNegativeResults = (negative != 0);
+                    }
+    settings.configs = configs;
+    settings.configCount = configCount;
+
+    printf("%d configurations x %d games, %.0f s each, bot accuracy %.2f, %d threads\n",
+           configCount, settings.gamesPerConfig, settings.duration, settings.accuracy, settings.threadCount);
+
+    // Shared read-only tables, built before any worker runs
+    InitEquationTables();
+
+    static SimWorker workers[MAX_THREADS];
+    static pthread_t threads[MAX_THREADS];
+    uint64_t start = GetClockNanoseconds();
+    for (int i = 0; i < settings.threadCount; i++) {
+        workers[i].settings = &settings;
+        workers[i].index = i;
+        workers[i].results = calloc(configCount, sizeof(SimResult));
+        if (workers[i].results == NULL || pthread_create(&threads[i], NULL, RunWorker, &workers[i]) != 0) {
+            fprintf(stderr, "Could not start worker %d\n", i);
+            return 1;
+        }
+    }
+
+    // Merge the workers' results once they are all done
+    static SimResult totals[MAX_CONFIGS];
+    for (int i = 0; i < settings.threadCount; i++) {
+        pthread_join(threads[i], NULL);
+        for (int config = 0; config < configCount; config++) {
+            const SimResult *result = &workers[i].results[config];
+            totals[config].games += result->games;
+            totals[config].gameOvers += result->gameOvers;
+            totals[config].survivalSum += result->survivalSum;
+            totals[config].scoreSum += result->scoreSum;
+            for (int k = 0; k < AMMO_CURVE_POINTS; k++) totals[config].ammoSum[k] += result->ammoSum[k];
+        }
+        free(workers[i].results);
+    }
+    double elapsed = (GetClockNanoseconds() - start)/1e9;
+
+    long long totalGames = 0;
+    for (int config = 0; config < configCount; config++) totalGames += totals[config].games;
+    printf("%lld games in %.1f s (%.0f games/s)\n\n", totalGames, elapsed, totalGames/elapsed);
+
+    // Mean ammo at a quarter, half, three quarters and the end of the duration
+    printf("%5s %6s %5s %5s %5s %8s %10s %11s %8s   %s\n", "cost", "reward", "ammo", "level", "neg",
+           "games", "game over", "survival s", "score", "ammo at 25% 50% 75% 100%");
+    for (int config = 0; config < configCount; config++) {
+        const SimConfig *c = &configs[config];
+        const SimResult *t = &totals[config];
+        if (t->games == 0) continue;
+        printf("%5d %6d %5d %5d %5s %8lld %9.2f%% %11.1f %8.1f   %5.1f %5.1f %5.1f %5.1f\n",
+               c->rules.shotCost, c->rules.hitReward, c->rules.initialAmmo, c->level,
+               c->allowNegativeResults ? "yes" : "no", t->games, 100.0*t->gameOvers/t->games,
+               t->survivalSum/t->games, t->scoreSum/t->games,
+               t->ammoSum[AMMO_CURVE_POINTS/4 - 1]/t->games, t->ammoSum[AMMO_CURVE_POINTS/2 - 1]/t->games,
+               t->ammoSum[3*AMMO_CURVE_POINTS/4 - 1]/t->games, t->ammoSum[AMMO_CURVE_POINTS - 1]/t->games);
+    }
+
+    // Full ammo curves, one row per configuration and sample
+    if (csvFile != NULL) {
+        FILE *csv = fopen(csvFile, "w");
+        if (csv == NULL) {
+            fprintf(stderr, "Could not write %s\n", csvFile);
+            return 1;
+        }
+        fprintf(csv, "shot_cost,hit_reward,initial_ammo,level,allow_negative,games,game_over_rate,mean_survival_s,time_s,mean_ammo\n");
+        for (int config = 0; config < configCount; config++) {
+            const SimConfig *c = &configs[config];
+            const SimResult *t = &totals[config];
+            if (t->games == 0) continue;
+            for (int k = 0; k < AMMO_CURVE_POINTS; k++) {
+                fprintf(csv, "%d,%d,%d,%d,%d,%lld,%.6f,%.3f,%.2f,%.4f\n",
+                        c->rules.shotCost, c->rules.hitReward, c->rules.initialAmmo, c->level, c->allowNegativeResults,
+                        t->games, (double)t->gameOvers/t->games, t->survivalSum/t->games,
+                        settings.duration*(k + 1)/AMMO_CURVE_POINTS, t->ammoSum[k]/t->games);
+            }
+        }
+        fclose(csv);
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+// sok_replay: plays a recorded session headless and prints the game state checksum
+// after every step, flagging the first step that no longer matches the recording.
+//
+// Usage: sok_replay FILE [--summary]
+
+#include "sok_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+    const char *fileName = NULL;
+    bool summaryOnly = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--summary") == 0) {
+            summaryOnly = true;
+        } else if (fileName == NULL && argv[i][0] != '-') {
+            fileName = argv[i];
+        } else {
+            fileName = NULL;
+            break;
+        }
+    }
+    if (fileName == NULL) {
+        printf("Usage: %s FILE [--summary]\n", argv[0]);
+        return 1;
+    }
+
+    ReplayFile replay;
+    if (!OpenReplay(&replay, fileName)) {
+        fprintf(stderr, "Could not open replay file %s\n", fileName);
+        return 1;
+    }
+
+    GameState *game = malloc(sizeof(GameState)); // Too large for the stack with the full drone pool
+    if (game == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        CloseReplay(&replay);
+        return 1;
+    }
+    InitGameFromReplay(game, &replay);
+
+    ReplayRecord record;
+    while (PlayReplayRecord(&replay, game, &record)) {
+        if (record.type == REPLAY_RECORD_STEP && !summaryOnly) {
+            unsigned int checksum = GetGameStateChecksum(game);
+            printf("%u %08x%s\n", replay.stepCount, checksum,
+                   (checksum != record.checksum) ? " MISMATCH" : "");
+        }
+    }
+
+    printf("seed %llu, %u steps, score %d, final checksum %08x\n", (unsigned long long)replay.seed,
+           replay.stepCount, game->score, GetGameStateChecksum(game));
+    if (replay.firstMismatch != 0) {
+        printf("Diverged from the recording at step %u\n", replay.firstMismatch);
+    }
+
+    bool matched = (replay.firstMismatch == 0);
+    CloseReplay(&replay);
+    UnloadGameState(game);
+    free(game);
+
+    return matched ? 0 : 1;
+}
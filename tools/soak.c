@@ -0,0 +1,60 @@
+// sok_soak: runs the headless simulation with the bot player for a fixed wall
+// clock duration and reports the frame time distribution, frames over budget and
+// resident memory growth. Progress lines every SOAK_REPORT_INTERVAL seconds show
+// whether frame times or memory drift over a long run.
+//
+// Usage: sok_soak [--duration SECONDS] [--budget MS] [--seed N] [--stress DRONES_PER_WAVE]
+//                 [--accuracy A] [--reaction SECONDS]
+
+#include "sok_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    double duration = 60.0;
+    double budgetMs = 1000.0/60.0;
+    uint64_t seed = 1;
+    int stressDrones = 0;
+    float accuracy = BOT_DEFAULT_ACCURACY;
+    float reaction = BOT_DEFAULT_REACTION_TIME;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            budgetMs = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--stress") == 0 && i + 1 < argc) {
+            stressDrones = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--accuracy") == 0 && i + 1 < argc) {
+            accuracy = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--reaction") == 0 && i + 1 < argc) {
+            reaction = (float)atof(argv[++i]);
+        } else {
+            printf("Usage: %s [--duration SECONDS] [--budget MS] [--seed N] [--stress DRONES_PER_WAVE] [--accuracy A] [--reaction SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static GameState game;      // Too large for the stack with the full drone pool
+    InitGameState(&game, seed);
+    game.dronesPerWave = stressDrones;
+
+    BotPlayer bot;
+    InitBotPlayer(&bot, accuracy, reaction, seed);
+
+    SoakTest soak;
+    BeginSoakTest(&soak, duration, budgetMs/1000.0);
+    RunHeadlessSoak(&soak, &game, &bot);
+    PrintSoakReport(&soak);
+
+    UnloadGameState(&game);
+
+    return 0;
+}
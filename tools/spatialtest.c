@@ -0,0 +1,238 @@
+// sok_spatialtest: checks the spatial grid's point and segment queries against a brute
+// force scan. Covers an item moving across cell boundaries one cell edge at a time,
+// segments spanning many cells past items that overlap several of them (every hit must
+// be reported once), and random items and queries. Exits with 1 on the first mismatch.
+//
+// Usage: sok_spatialtest [--seed N] [--rounds N]
+
+#include "sok_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+//------------------------------------------------------------------------------------
+// Reference Queries
+//------------------------------------------------------------------------------------
+static bool IsPointInRectRef(Rectangle rect, Vector2 point) {
+    return (point.x >= rect.x) && (point.x < rect.x + rect.width) &&
+           (point.y >= rect.y) && (point.y < rect.y + rect.height);
+}
+
+// Closest approach of the segment to the rectangle by fine sampling, good enough for
+// segments that either clearly cross or clearly miss (see IsClearCase)
+static bool SegmentTouchesRectRef(Vector2 start, Vector2 end, Rectangle rect) {
+    for (int i = 0; i <= 4096; i++) {
+        float t = i / 4096.0f;
+        float x = start.x + t * (end.x - start.x);
+        float y = start.y + t * (end.y - start.y);
+        if (x >= rect.x && x <= rect.x + rect.width && y >= rect.y && y <= rect.y + rect.height) return true;
+    }
+    return false;
+}
+
+// Items the grid indexes: those overlapping the field
+static bool IsIndexed(Rectangle rect) {
+    float width = (float)(SPATIAL_GRID_COLS * SPATIAL_CELL_SIZE);
+    float height = (float)(SPATIAL_GRID_ROWS * SPATIAL_CELL_SIZE);
+    return rect.x + rect.width > 0.0f && rect.y + rect.height > 0.0f && rect.x < width && rect.y < height;
+}
+
+//------------------------------------------------------------------------------------
+// Checks
+//------------------------------------------------------------------------------------
+// Every id in results is expected, none is listed twice and none is missing
+static void CheckResults(const char *what, const int *results, int found, const bool *expected, int itemCount) {
+    static int seen[MAX_DRONES];
+    memset(seen, 0, sizeof(seen));
+    for (int i = 0; i < found; i++) {
+        int id = results[i];
+        if (id < 0 || id >= itemCount) {
+            printf("FAIL %s: id %d out of range\n", what, id);
+            failures++;
+            return;
+        }
+        if (++seen[id] > 1) {
+            printf("FAIL %s: id %d reported %d times\n", what, id, seen[id]);
+            failures++;
+        }
+        if (!expected[id]) {
+            printf("FAIL %s: id %d reported but not hit\n", what, id);
+            failures++;
+        }
+    }
+    for (int id = 0; id < itemCount; id++) {
+        if (expected[id] && seen[id] == 0) {
+            printf("FAIL %s: id %d hit but not reported\n", what, id);
+            failures++;
+        }
+    }
+}
+
+// One item walks right and down across cell edges; after every move the cells it left
+// must not report it and the cells it entered must
+static void CheckBoundaryCrossing(SpatialGrid *grid) {
+    InitSpatialGrid(grid);
+    const float size = 100.0f;
+    const float edge = (float)SPATIAL_CELL_SIZE;
+    const float xs[] = { edge - size - 1.0f, edge - size, edge - size + 0.5f, edge - 1.0f, edge, edge + 50.0f };
+    int results[MAX_DRONES];
+    bool expected[1];
+    char what[96];
+
+    for (int i = 0; i < (int)(sizeof(xs)/sizeof(xs[0])); i++) {
+        Rectangle rect = { xs[i], xs[i], size, size };
+        UpdateSpatialItem(grid, 0, rect);
+
+        // Probe points just inside and outside each edge, in both cells around the boundary
+        const float probes[] = { rect.x - 0.5f, rect.x, rect.x + size - 0.5f, rect.x + size, edge - 0.5f, edge };
+        for (int p = 0; p < (int)(sizeof(probes)/sizeof(probes[0])); p++) {
+            Vector2 point = { probes[p], probes[p] };
+            expected[0] = IsPointInRectRef(rect, point);
+            int found = QuerySpatialPoint(grid, point, results, MAX_DRONES);
+            snprintf(what, sizeof(what), "crossing x=%.1f point %.1f", xs[i], probes[p]);
+            CheckResults(what, results, found, expected, 1);
+        }
+
+        // A segment along the boundary row of cells and one staying in the cell just left
+        Vector2 start = { 0.5f, rect.y + size/2 };
+        Vector2 end = { edge*2 - 0.5f, rect.y + size/2 };
+        expected[0] = true;
+        int found = QuerySpatialSegment(grid, start, end, results, MAX_DRONES);
+        snprintf(what, sizeof(what), "crossing x=%.1f segment through", xs[i]);
+        CheckResults(what, results, found, expected, 1);
+
+        end.x = rect.x - 5.0f;
+        expected[0] = false;
+        found = QuerySpatialSegment(grid, start, end, results, MAX_DRONES);
+        snprintf(what, sizeof(what), "crossing x=%.1f segment short", xs[i]);
+        CheckResults(what, results, found, expected, 1);
+    }
+
+    // Leaving the field unlinks it everywhere
+    UpdateSpatialItem(grid, 0, (Rectangle){ -300.0f, 50.0f, size, size });
+    bool none[1] = { false };
+    int found = QuerySpatialSegment(grid, (Vector2){ 0.0f, 0.0f }, (Vector2){ edge*2, edge*2 }, results, MAX_DRONES);
+    CheckResults("crossing off field", results, found, none, 1);
+}
+
+// Items straddling cell corners, so each sits in up to four cells, hit by a diagonal
+// through every row and a horizontal line through every column
+static void CheckMultiCellSegment(SpatialGrid *grid) {
+    InitSpatialGrid(grid);
+    const float edge = (float)SPATIAL_CELL_SIZE;
+    int itemCount = 0;
+    static Rectangle rects[MAX_DRONES];
+    for (int row = 1; row < SPATIAL_GRID_ROWS; row++) {
+        for (int col = 1; col < SPATIAL_GRID_COLS; col++) {
+            rects[itemCount] = (Rectangle){ col*edge - 60.0f, row*edge - 60.0f, 120.0f, 120.0f };
+            UpdateSpatialItem(grid, itemCount, rects[itemCount]);
+            itemCount++;
+        }
+    }
+
+    const Vector2 segments[][2] = {
+        { { 0.5f, 0.5f }, { SCREEN_WIDTH - 0.5f, SCREEN_HEIGHT - 0.5f } },
+        { { SCREEN_WIDTH - 0.5f, SCREEN_HEIGHT - 0.5f }, { 0.5f, 0.5f } },
+        { { 0.5f, edge }, { SCREEN_WIDTH - 0.5f, edge } },
+        { { edge*2, 0.5f }, { edge*2, SCREEN_HEIGHT - 0.5f } },
+        { { -100.0f, edge + 10.0f }, { SCREEN_WIDTH + 100.0f, edge*2 - 10.0f } },
+    };
+    int results[MAX_DRONES];
+    static bool expected[MAX_DRONES];
+    char what[64];
+    for (int s = 0; s < (int)(sizeof(segments)/sizeof(segments[0])); s++) {
+        for (int id = 0; id < itemCount; id++) expected[id] = SegmentTouchesRectRef(segments[s][0], segments[s][1], rects[id]);
+        int found = QuerySpatialSegment(grid, segments[s][0], segments[s][1], results, MAX_DRONES);
+        snprintf(what, sizeof(what), "multi-cell segment %d", s);
+        CheckResults(what, results, found, expected, itemCount);
+        if (found < 2) {
+            printf("FAIL %s: only %d hits, the case is not exercising several cells\n", what, found);
+            failures++;
+        }
+    }
+}
+
+// A segment is clear when it either misses the rectangle grown by a margin or
+// crosses the rectangle shrunk by it, so sampling cannot disagree with the exact test
+static bool IsClearCase(Vector2 start, Vector2 end, Rectangle rect) {
+    const float margin = 1.0f;
+    Rectangle grown = { rect.x - margin, rect.y - margin, rect.width + 2*margin, rect.height + 2*margin };
+    Rectangle shrunk = { rect.x + margin, rect.y + margin, rect.width - 2*margin, rect.height - 2*margin };
+    return !SegmentTouchesRectRef(start, end, grown) || SegmentTouchesRectRef(start, end, shrunk);
+}
+
+// Random items moved around in place, then random point and segment queries
+static void CheckRandom(SpatialGrid *grid, uint64_t seed, int rounds) {
+    InitSpatialGrid(grid);
+    RandomStream random;
+    SeedRandomStream(&random, seed, 0);
+    const int itemCount = 512;
+    static Rectangle rects[MAX_DRONES];
+    int results[MAX_DRONES];
+    static bool expected[MAX_DRONES];
+    char what[64];
+
+    for (int round = 0; round < rounds; round++) {
+        for (int id = 0; id < itemCount; id++) {
+            float size = 10.0f + GetRandomBelow(&random, DRONE_TEXTURE_SIZE * (int)DRONE_SCALE - 10);
+            rects[id] = (Rectangle){ -250.0f + GetRandomBelow(&random, SCREEN_WIDTH + 500) + GetRandomBelow(&random, 8)/8.0f,
+                                     -250.0f + GetRandomBelow(&random, SCREEN_HEIGHT + 500) + GetRandomBelow(&random, 8)/8.0f,
+                                     size, size };
+            UpdateSpatialItem(grid, id, rects[id]);
+        }
+
+        for (int q = 0; q < 64; q++) {
+            Vector2 point = { GetRandomBelow(&random, SCREEN_WIDTH*4)/4.0f, GetRandomBelow(&random, SCREEN_HEIGHT*4)/4.0f };
+            for (int id = 0; id < itemCount; id++) expected[id] = IsPointInRectRef(rects[id], point);
+            int found = QuerySpatialPoint(grid, point, results, MAX_DRONES);
+            snprintf(what, sizeof(what), "random round %d point %d", round, q);
+            CheckResults(what, results, found, expected, itemCount);
+        }
+
+        for (int q = 0; q < 16; q++) {
+            Vector2 start = { -100.0f + GetRandomBelow(&random, SCREEN_WIDTH + 200), -100.0f + GetRandomBelow(&random, SCREEN_HEIGHT + 200) };
+            Vector2 end = { -100.0f + GetRandomBelow(&random, SCREEN_WIDTH + 200), -100.0f + GetRandomBelow(&random, SCREEN_HEIGHT + 200) };
+            bool clear = true;
+            for (int id = 0; id < itemCount && clear; id++) clear = IsClearCase(start, end, rects[id]);
+            if (!clear) continue;
+
+            for (int id = 0; id < itemCount; id++) expected[id] = IsIndexed(rects[id]) && SegmentTouchesRectRef(start, end, rects[id]);
+            int found = QuerySpatialSegment(grid, start, end, results, MAX_DRONES);
+            snprintf(what, sizeof(what), "random round %d segment %d", round, q);
+            CheckResults(what, results, found, expected, itemCount);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    uint64_t seed = 1;
+    int rounds = 20;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else {
+            printf("Usage: %s [--seed N] [--rounds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static SpatialGrid grid;    // Too large for the stack
+    CheckBoundaryCrossing(&grid);
+    CheckMultiCellSegment(&grid);
+    CheckRandom(&grid, seed, rounds);
+
+    if (failures > 0) {
+        printf("%d spatial grid check(s) failed\n", failures);
+        return 1;
+    }
+    printf("Spatial grid checks passed\n");
+    return 0;
+}